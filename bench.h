@@ -0,0 +1,21 @@
+#ifndef BENCH_H_INCLUDED
+#define BENCH_H_INCLUDED
+
+#include <string>
+
+#define BENCH_DEPTH 10
+#define BENCH_HASH 16
+
+namespace Sloth {
+	namespace Bench {
+		// searches a fixed set of positions to a fixed depth, each one with an empty hash table, and prints the
+		// total nodes, time and nps. With one thread the node count only changes when the search does
+		void bench(int depth, int hashMb, int threads, bool listen = true);
+
+		// "[depth] [hash] [threads]" as typed after bench in uci or on the command line, missing values are the defaults.
+		// Without listen the search does not stop on input, stdin may be closed on the command line
+		void benchCommand(const std::string& args, bool listen = true);
+	}
+}
+
+#endif
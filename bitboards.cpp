@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <cstdint>
+#include <cstdlib>
 #if defined(__arm__) || defined(__aarch64__)
 #include <arm_neon.h>
 #elif defined(_MSC_VER)
@@ -17,111 +18,180 @@
 #include "types.h"
 
 namespace Sloth {
-	const U64 Bitboards::notAFile = 18374403900871474942ULL;
-	const U64 Bitboards::notHFile = 9187201950435737471ULL;
+	constexpr U64 Bitboards::notAFile = 18374403900871474942ULL;
+	constexpr U64 Bitboards::notHFile = 9187201950435737471ULL;
 
-	const U64 Bitboards::notHGFile = 4557430888798830399ULL;
-	const U64 Bitboards::notABFile = 18229723555195321596ULL;
+	constexpr U64 Bitboards::notHGFile = 4557430888798830399ULL;
+	constexpr U64 Bitboards::notABFile = 18229723555195321596ULL;
 
-	U64 Bitboards::pawnAttacks[2][64];
-	U64 Bitboards::knightAttacks[64];
-	U64 Bitboards::kingAttacks[64];
-
-	U64 Bitboards::bitboards[12];
-	U64 Bitboards::occupancies[3];
-
-	void Bitboards::printBitboard(U64 bb, bool flip) {
-		if (flip) {
-			for (int rank = 7; rank >= 0; rank--) {
-				for (int file = 0; file < 8; file++) {
-					int square = rank * 8 + file;
-					char piece = (bb & (1ULL << square)) ? '1' : '0';
-					std::cout << piece << ' ';
-				}
-				std::cout << std::endl;
-			}
-		}
-		else {
-			for (int rank = 0; rank < 8; rank++) {
-				for (int file = 0; file < 8; file++) {
-					int square = rank * 8 + file;
-					char piece = (bb & (1ULL << square)) ? '1' : '0';
-					std::cout << piece << ' ';
-				}
-				std::cout << std::endl;
-			}
-		}
-		printf("\n\nBitboard: %llu\n\n", bb);
-	}
-
-	U64 Bitboards::openFileCount(U64 pawns) {
-		pawns |= pawns >> 8; pawns |= pawns >> 16; pawns |= pawns >> 32;
-		return countBits(~pawns & 0xFF);
-	}
-
-	U64 Bitboards::pawnAdvance(U64 pawns, U64 occ, int color) {
-		return ~occ & (color == Colors::white ? (pawns >> 8) : (pawns << 8));
-	}
-
-	U64 Bitboards::maskPawnAttacks(int square, int side) {
+	static constexpr U64 maskPawnAttacks(int square, int side) {
 		U64 attacks = 0ULL;
 		U64 bitboard = 0ULL;
 		setBit(bitboard, square);
 
 		if (!side) {
-			if ((bitboard >> 7) & notAFile) attacks |= (bitboard >> 7);
-			if ((bitboard >> 9) & notHFile) attacks |= (bitboard >> 9);
+			if ((bitboard >> 7) & Bitboards::notAFile) attacks |= (bitboard >> 7);
+			if ((bitboard >> 9) & Bitboards::notHFile) attacks |= (bitboard >> 9);
 		}
 		else {
-			if ((bitboard << 7) & notHFile) attacks |= (bitboard << 7);
-			if ((bitboard << 9) & notAFile) attacks |= (bitboard << 9);
+			if ((bitboard << 7) & Bitboards::notHFile) attacks |= (bitboard << 7);
+			if ((bitboard << 9) & Bitboards::notAFile) attacks |= (bitboard << 9);
 		}
 		return attacks;
 	}
 
-	U64 Bitboards::maskKnightAttacks(int square) {
+	static constexpr U64 maskKnightAttacks(int square) {
 		U64 attacks = 0ULL;
 		U64 bitboard = 0ULL;
 		setBit(bitboard, square);
 
-		if ((bitboard >> 17) & notHFile) attacks |= (bitboard >> 17);
-		if ((bitboard >> 15) & notAFile) attacks |= (bitboard >> 15);
-		if ((bitboard >> 10) & notHGFile) attacks |= (bitboard >> 10);
-		if ((bitboard >> 6) & notABFile) attacks |= (bitboard >> 6);
+		if ((bitboard >> 17) & Bitboards::notHFile) attacks |= (bitboard >> 17);
+		if ((bitboard >> 15) & Bitboards::notAFile) attacks |= (bitboard >> 15);
+		if ((bitboard >> 10) & Bitboards::notHGFile) attacks |= (bitboard >> 10);
+		if ((bitboard >> 6) & Bitboards::notABFile) attacks |= (bitboard >> 6);
 	
-		if ((bitboard << 17) & notAFile) attacks |= (bitboard << 17);
-		if ((bitboard << 15) & notHFile) attacks |= (bitboard << 15);
-		if ((bitboard << 10) & notABFile) attacks |= (bitboard << 10);
-		if ((bitboard << 6) & notHGFile) attacks |= (bitboard << 6);
+		if ((bitboard << 17) & Bitboards::notAFile) attacks |= (bitboard << 17);
+		if ((bitboard << 15) & Bitboards::notHFile) attacks |= (bitboard << 15);
+		if ((bitboard << 10) & Bitboards::notABFile) attacks |= (bitboard << 10);
+		if ((bitboard << 6) & Bitboards::notHGFile) attacks |= (bitboard << 6);
 
 		return attacks;
 	}
 
-	U64 Bitboards::maskKingAttacks(int square) {
+	static constexpr U64 maskKingAttacks(int square) {
 		U64 attacks = 0ULL;
 		U64 bitboard = 0ULL;
 		setBit(bitboard, square);
 
 		if (bitboard >> 8) attacks |= (bitboard >> 8);
-		if ((bitboard >> 9) & notHFile) attacks |= (bitboard >> 9);
-		if ((bitboard >> 7) & notAFile) attacks |= (bitboard >> 7);
-		if ((bitboard >> 1) & notHFile) attacks |= (bitboard >> 1);
+		if ((bitboard >> 9) & Bitboards::notHFile) attacks |= (bitboard >> 9);
+		if ((bitboard >> 7) & Bitboards::notAFile) attacks |= (bitboard >> 7);
+		if ((bitboard >> 1) & Bitboards::notHFile) attacks |= (bitboard >> 1);
 
 		if (bitboard << 8) attacks |= (bitboard << 8);
-		if ((bitboard << 9) & notAFile) attacks |= (bitboard << 9);
-		if ((bitboard << 7) & notHFile) attacks |= (bitboard << 7);
-		if ((bitboard << 1) & notAFile) attacks |= (bitboard << 1);
+		if ((bitboard << 9) & Bitboards::notAFile) attacks |= (bitboard << 9);
+		if ((bitboard << 7) & Bitboards::notHFile) attacks |= (bitboard << 7);
+		if ((bitboard << 1) & Bitboards::notAFile) attacks |= (bitboard << 1);
 		
 		return attacks;
 	}
 
-	void Bitboards::initLeaperAttacks() {
+	// the tables below are computed while compiling and live in read-only data, nothing is set up at startup
+	constexpr std::array<std::array<U64, 64>, 2> Bitboards::pawnAttacks = [] {
+		std::array<std::array<U64, 64>, 2> table{};
+
 		for (int square = 0; square < 64; square++) {
-			Bitboards::pawnAttacks[Colors::white][square] = maskPawnAttacks(square, Colors::white);
-			Bitboards::pawnAttacks[Colors::black][square] = maskPawnAttacks(square, Colors::black);
-			Bitboards::knightAttacks[square] = maskKnightAttacks(square);
-			Bitboards::kingAttacks[square] = maskKingAttacks(square);
+			table[Colors::white][square] = maskPawnAttacks(square, Colors::white);
+			table[Colors::black][square] = maskPawnAttacks(square, Colors::black);
+		}
+
+		return table;
+	}();
+
+	constexpr std::array<U64, 64> Bitboards::knightAttacks = [] {
+		std::array<U64, 64> table{};
+
+		for (int square = 0; square < 64; square++) table[square] = maskKnightAttacks(square);
+
+		return table;
+	}();
+
+	constexpr std::array<U64, 64> Bitboards::kingAttacks = [] {
+		std::array<U64, 64> table{};
+
+		for (int square = 0; square < 64; square++) table[square] = maskKingAttacks(square);
+
+		return table;
+	}();
+
+	// direction of the step from one square towards another, false when they share no rank, file or diagonal
+	static constexpr bool lineStep(int from, int to, int& rankStep, int& fileStep) {
+		int rankDelta = to / 8 - from / 8;
+		int fileDelta = to % 8 - from % 8;
+
+		if (from == to || (rankDelta && fileDelta && rankDelta != fileDelta && rankDelta != -fileDelta)) return false;
+
+		rankStep = (rankDelta > 0) - (rankDelta < 0);
+		fileStep = (fileDelta > 0) - (fileDelta < 0);
+
+		return true;
+	}
+
+	constexpr std::array<std::array<U64, 64>, 64> Bitboards::betweenSquares = [] {
+		std::array<std::array<U64, 64>, 64> table{};
+
+		for (int from = 0; from < 64; from++) {
+			for (int to = 0; to < 64; to++) {
+				int rankStep = 0, fileStep = 0;
+
+				if (!lineStep(from, to, rankStep, fileStep)) continue;
+
+				for (int r = from / 8 + rankStep, f = from % 8 + fileStep; r * 8 + f != to; r += rankStep, f += fileStep) {
+					setBit(table[from][to], (r * 8 + f));
+				}
+			}
+		}
+
+		return table;
+	}();
+
+	constexpr std::array<std::array<U64, 64>, 64> Bitboards::lineThrough = [] {
+		std::array<std::array<U64, 64>, 64> table{};
+
+		for (int from = 0; from < 64; from++) {
+			for (int to = 0; to < 64; to++) {
+				int rankStep = 0, fileStep = 0;
+
+				if (!lineStep(from, to, rankStep, fileStep)) continue;
+
+				// walk from one edge of the board to the other through both squares
+				int r = from / 8, f = from % 8;
+
+				while (r - rankStep >= 0 && r - rankStep < 8 && f - fileStep >= 0 && f - fileStep < 8) {
+					r -= rankStep;
+					f -= fileStep;
+				}
+
+				for (; r >= 0 && r < 8 && f >= 0 && f < 8; r += rankStep, f += fileStep) {
+					setBit(table[from][to], (r * 8 + f));
+				}
+			}
 		}
+
+		return table;
+	}();
+
+	void Bitboards::printBitboard(U64 bb, bool flip) {
+		if (flip) {
+			for (int rank = 7; rank >= 0; rank--) {
+				for (int file = 0; file < 8; file++) {
+					int square = rank * 8 + file;
+					char piece = (bb & (1ULL << square)) ? '1' : '0';
+					std::cout << piece << ' ';
+				}
+				std::cout << std::endl;
+			}
+		}
+		else {
+			for (int rank = 0; rank < 8; rank++) {
+				for (int file = 0; file < 8; file++) {
+					int square = rank * 8 + file;
+					char piece = (bb & (1ULL << square)) ? '1' : '0';
+					std::cout << piece << ' ';
+				}
+				std::cout << std::endl;
+			}
+		}
+		printf("\n\nBitboard: %llu\n\n", bb);
+	}
+
+	U64 Bitboards::openFileCount(U64 pawns) {
+		pawns |= pawns >> 8; pawns |= pawns >> 16; pawns |= pawns >> 32;
+		return countBits(~pawns & 0xFF);
+	}
+
+	U64 Bitboards::pawnAdvance(U64 pawns, U64 occ, int color) {
+		return ~occ & (color == Colors::white ? (pawns >> 8) : (pawns << 8));
 	}
 
 	int Bitboards::countBits(U64 bb) {
@@ -156,5 +226,77 @@ namespace Sloth {
 		return 63 - __builtin_clzll(bitboard);      // for GCC/Clang - JA
         #endif	
 	}
+
+#ifdef __AVX2__
+	// every lane moves its bitboard one way: lanes with a left count go towards h1, lanes with a right count
+	// towards a8. The other count is 64 or more, which shifts the lane out to nothing
+	static inline __m256i shiftLanes(__m256i bb, __m256i left, __m256i right) {
+		return _mm256_or_si256(_mm256_sllv_epi64(bb, left), _mm256_srlv_epi64(bb, right));
+	}
+
+	// Kogge-Stone occluded fill of all four lanes at once: the sliders are smeared along their direction over
+	// the empty squares in three doubling steps, wrap masks the squares a step may not land on (file wraps)
+	static inline __m256i rayAttacks(__m256i sliders, __m256i empty, __m256i left, __m256i right, __m256i wrap) {
+		__m256i gen = sliders;
+		__m256i pro = _mm256_and_si256(empty, wrap);
+		__m256i left2 = _mm256_add_epi64(left, left), right2 = _mm256_add_epi64(right, right);
+		__m256i left4 = _mm256_add_epi64(left2, left2), right4 = _mm256_add_epi64(right2, right2);
+
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftLanes(gen, left, right)));
+		pro = _mm256_and_si256(pro, shiftLanes(pro, left, right));
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftLanes(gen, left2, right2)));
+		pro = _mm256_and_si256(pro, shiftLanes(pro, left2, right2));
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftLanes(gen, left4, right4)));
+
+		// one more step onto the blockers, which are attacked too
+		return _mm256_and_si256(shiftLanes(gen, left, right), wrap);
+	}
+
+	// lanes: down a file (+8), towards the h file (+1), up a file (-8), towards the a file (-1)
+	static inline __m256i rookRays(U64 rookLike, U64 empty) {
+		const __m256i left = _mm256_set_epi64x(64, 64, 1, 8);
+		const __m256i right = _mm256_set_epi64x(1, 8, 64, 64);
+		const __m256i wrap = _mm256_set_epi64x(Bitboards::notHFile, ~0ULL, Bitboards::notAFile, ~0ULL);
+
+		return rayAttacks(_mm256_set1_epi64x(rookLike), _mm256_set1_epi64x(empty), left, right, wrap);
+	}
+
+	// lanes: +9 and -7 towards the h file, +7 and -9 towards the a file
+	static inline __m256i bishopRays(U64 bishopLike, U64 empty) {
+		const __m256i left = _mm256_set_epi64x(64, 64, 7, 9);
+		const __m256i right = _mm256_set_epi64x(9, 7, 64, 64);
+		const __m256i wrap = _mm256_set_epi64x(Bitboards::notHFile, Bitboards::notAFile, Bitboards::notHFile, Bitboards::notAFile);
+
+		return rayAttacks(_mm256_set1_epi64x(bishopLike), _mm256_set1_epi64x(empty), left, right, wrap);
+	}
+
+	static inline U64 orLanes(__m256i bb) {
+		__m128i half = _mm_or_si128(_mm256_castsi256_si128(bb), _mm256_extracti128_si256(bb, 1));
+
+		return (U64)(_mm_cvtsi128_si64(half) | _mm_extract_epi64(half, 1));
+	}
+
+	U64 Bitboards::sliderAttacks(U64 rookLike, U64 bishopLike, U64 occ) {
+		return orLanes(_mm256_or_si256(rookRays(rookLike, ~occ), bishopRays(bishopLike, ~occ)));
+	}
+
+	// a square is attacked at most once from each direction, so two of the eight directions overlapping is a
+	// second attacker. The overlaps are collected with two lane swaps instead of going through the eight rays
+	U64 Bitboards::sliderAttacksTwice(U64 rookLike, U64 bishopLike, U64 occ, U64& attacked) {
+		__m256i rook = rookRays(rookLike, ~occ), bishop = bishopRays(bishopLike, ~occ);
+		__m256i once = _mm256_or_si256(rook, bishop);
+		__m256i twice = _mm256_and_si256(rook, bishop);
+		__m256i swapped = _mm256_permute4x64_epi64(once, 0xB1); // lanes 1 0 3 2
+
+		twice = _mm256_or_si256(twice, _mm256_and_si256(once, swapped));
+		once = _mm256_or_si256(once, swapped);
+		swapped = _mm256_permute4x64_epi64(once, 0x4E); // lanes 2 3 0 1
+		twice = _mm256_or_si256(twice, _mm256_and_si256(once, swapped));
+
+		attacked = orLanes(once);
+
+		return orLanes(twice);
+	}
+#endif
 }
 
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cassert>
 #include <vector>
+#include <array>
 
 #define setBit(bb, sq) (bb |= (1ULL << sq))
 #define getBit(bb, sq) (bb & (1ULL << sq))
@@ -22,30 +23,30 @@ namespace Sloth {
 		extern const U64 notHGFile;
 		extern const U64 notABFile;
 
-		extern U64 pawnAttacks[2][64]; // [side][square]
-		extern U64 knightAttacks[64]; // [square]
-		extern U64 kingAttacks[64];
+		// built by the compiler, see bitboards.cpp
+		extern const std::array<std::array<U64, 64>, 2> pawnAttacks; // [side][square]
+		extern const std::array<U64, 64> knightAttacks; // [square]
+		extern const std::array<U64, 64> kingAttacks;
 
-		// 12 bitboards, each piece and each color
-		extern U64 bitboards[12];
-		extern U64 occupancies[3]; // This will hold every piece on one bitboard. One for every white piece combined, one for black combined and one with every piece of both color on the bitboard
+		extern const std::array<std::array<U64, 64>, 64> betweenSquares; // squares strictly between two squares on a common line, else 0
+		extern const std::array<std::array<U64, 64>, 64> lineThrough; // the whole rank, file or diagonal through two squares, else 0
 
 		void printBitboard(U64 bb, bool flip);
 
 		U64 openFileCount(U64 pawns);
 		U64 pawnAdvance(U64 pawns, U64 occ, int color);
 
-		U64 maskPawnAttacks(int square, int side);
-		U64 maskKnightAttacks(int square);
-		U64 maskKingAttacks(int square);
-
-		void initLeaperAttacks();
-
 		extern  int countBits(U64 bitboard); // counts every bit available on a bitboard
 
 		// get least significant 1st bit index
 		extern int getLs1bIndex(U64 bitboard);
 		extern int msb(U64 bb);
+
+#ifdef __AVX2__
+		// squares attacked by all rook-like and all bishop-like pieces of a side, without a loop over the pieces
+		U64 sliderAttacks(U64 rookLike, U64 bishopLike, U64 occ);
+		U64 sliderAttacksTwice(U64 rookLike, U64 bishopLike, U64 occ, U64& attacked); // by two of them, attacked gets the union
+#endif
 	}
 }
 
@@ -11,22 +11,6 @@
 
 namespace Sloth {
 
-    U64 Eval::fileMasks[64];
-    U64 Eval::rankMasks[64];
-
-    U64 Eval::isolatedMasks[64];
-    U64 Eval::wPassedMasks[64];
-    U64 Eval::bPassedMasks[64];
-
-    struct {
-        int gamePhase = -1;
-        int phaseScore;
-    } phase;
-
-    struct {
-        int score = 0, scoreOpening = 0, scoreEndgame = 0;
-    } scores;
-
     struct PieceScore {
         int scoreOpening = 0;
         int scoreEndgame = 0;
@@ -68,8 +52,6 @@ namespace Sloth {
         S(-9,  -6), S(-12, -20), S(-27, -20), S(-47, -19),
     };
 
-    U64 forwardRanksMasks[2][8];
-
     static const PieceScore pawnShield[] = {
         {-19, -17},
         {0, -12},
@@ -101,12 +83,14 @@ namespace Sloth {
     const int openingScore = 6192;
     const int endgameScore = 518;
 
-    U64 Eval::setFileRankMask(int fileNum, int rankNum) {
+    // file 8 runs off the board: bit 64 wraps round to bit 0 as the shift did when this was filled at startup,
+    // so the mask becomes the a file and the h file pawn masks keep the values they were tuned with
+    static constexpr U64 setFileRankMask(int fileNum, int rankNum) {
         U64 mask = 0ULL;
 
         for (int i = 0; i < 8; i++) {
             if (fileNum != -1) {
-                mask |= setBit(mask, (i * 8 + fileNum));
+                mask |= setBit(mask, ((i * 8 + fileNum) & 63));
             }
             else if (rankNum != -1) {
                 mask |= setBit(mask, (rankNum * 8 + i));
@@ -116,79 +100,130 @@ namespace Sloth {
         return mask;
     }
 
-    int rankOf(int sq) {
+    constexpr int rankOf(int sq) {
         return sq / 8;
     }
 
-    int fileOf(int sq) {
+    constexpr int fileOf(int sq) {
         return sq % 8;
     }
 
-    U64 backwardMasks[64];
-    U64 connectedMasks[64];
+    // the tables below are computed while compiling, nothing is set up at startup
+    constexpr std::array<U64, 64> Eval::fileMasks = [] {
+        std::array<U64, 64> table{};
 
-    int distanceBetween[64][64];
+        for (int sq = 0; sq < 64; sq++) table[sq] = setFileRankMask(fileOf(sq), -1);
 
-    void Eval::initEvalMasks() {
-        for (int sq1 = 0; sq1 < 64; sq1++)
-            for (int sq2 = 0; sq2 < 64; sq2++)
-                distanceBetween[sq1][sq2] = std::max(std::abs(fileOf(sq1) - fileOf(sq2)), std::abs(rankOf(sq1) - rankOf(sq2)));
+        return table;
+    }();
 
-        for (int rank = 0; rank < 8; rank++) {
-            for (int file = 0; file < 8; file++) {
-                int sq = rank * 8 + file;
+    constexpr std::array<U64, 64> Eval::rankMasks = [] {
+        std::array<U64, 64> table{};
 
-                fileMasks[sq] |= setFileRankMask(file, -1);
-                rankMasks[sq] |= setFileRankMask(-1, rank);
+        for (int sq = 0; sq < 64; sq++) table[sq] = setFileRankMask(-1, rankOf(sq));
 
-                isolatedMasks[sq] |= setFileRankMask(file - 1, -1);
-                isolatedMasks[sq] |= setFileRankMask(file + 1, -1);
+        return table;
+    }();
 
-                for (int r = rank - 1; r >= 0; r--) {
-                    if (file > 0) backwardMasks[sq] |= (1ULL << (r * 8 + (file - 1)));
-                    if (file < 7) backwardMasks[sq] |= (1ULL << (r * 8 + (file + 1)));
-                }
+    constexpr std::array<U64, 64> Eval::isolatedMasks = [] {
+        std::array<U64, 64> table{};
 
-                if (file > 0) {
-                    connectedMasks[sq] |= (1ULL << (rank * 8 + (file - 1)));
-                    if (rank > 0) connectedMasks[sq] |= (1ULL << ((rank - 1) * 8 + (file - 1)));
-                    if (rank < 7) connectedMasks[sq] |= (1ULL << ((rank + 1) * 8 + (file - 1)));
-                }
-                if (file < 7) {
-                    connectedMasks[sq] |= (1ULL << (rank * 8 + (file + 1)));
-                    if (rank > 0) connectedMasks[sq] |= (1ULL << ((rank - 1) * 8 + (file + 1)));
-                    if (rank < 7) connectedMasks[sq] |= (1ULL << ((rank + 1) * 8 + (file + 1)));
-                }
+        for (int sq = 0; sq < 64; sq++) table[sq] = setFileRankMask(fileOf(sq) - 1, -1) | setFileRankMask(fileOf(sq) + 1, -1);
+
+        return table;
+    }();
+
+    constexpr std::array<U64, 64> backwardMasks = [] {
+        std::array<U64, 64> table{};
+
+        for (int sq = 0; sq < 64; sq++) {
+            int rank = rankOf(sq), file = fileOf(sq);
+
+            for (int r = rank - 1; r >= 0; r--) {
+                if (file > 0) table[sq] |= (1ULL << (r * 8 + (file - 1)));
+                if (file < 7) table[sq] |= (1ULL << (r * 8 + (file + 1)));
+            }
+        }
+
+        return table;
+    }();
+
+    constexpr std::array<U64, 64> connectedMasks = [] {
+        std::array<U64, 64> table{};
+
+        for (int sq = 0; sq < 64; sq++) {
+            int rank = rankOf(sq), file = fileOf(sq);
+
+            if (file > 0) {
+                table[sq] |= (1ULL << (rank * 8 + (file - 1)));
+                if (rank > 0) table[sq] |= (1ULL << ((rank - 1) * 8 + (file - 1)));
+                if (rank < 7) table[sq] |= (1ULL << ((rank + 1) * 8 + (file - 1)));
+            }
+            if (file < 7) {
+                table[sq] |= (1ULL << (rank * 8 + (file + 1)));
+                if (rank > 0) table[sq] |= (1ULL << ((rank - 1) * 8 + (file + 1)));
+                if (rank < 7) table[sq] |= (1ULL << ((rank + 1) * 8 + (file + 1)));
             }
         }
 
+        return table;
+    }();
+
+    constexpr std::array<std::array<int, 64>, 64> distanceBetween = [] {
+        std::array<std::array<int, 64>, 64> table{};
+
+        for (int sq1 = 0; sq1 < 64; sq1++) {
+            for (int sq2 = 0; sq2 < 64; sq2++) {
+                int fileDistance = fileOf(sq1) > fileOf(sq2) ? fileOf(sq1) - fileOf(sq2) : fileOf(sq2) - fileOf(sq1);
+                int rankDistance = rankOf(sq1) > rankOf(sq2) ? rankOf(sq1) - rankOf(sq2) : rankOf(sq2) - rankOf(sq1);
+
+                table[sq1][sq2] = std::max(fileDistance, rankDistance);
+            }
+        }
+
+        return table;
+    }();
+
+    constexpr std::array<std::array<U64, 8>, 2> forwardRanksMasks = [] {
+        std::array<std::array<U64, 8>, 2> table{};
+
         for (int rank = 0; rank < 8; rank++) {
             for (int i = rank; i < 8; i++)
-                forwardRanksMasks[Colors::white][rank] |= rankMasks[i];
-            forwardRanksMasks[Colors::black][rank] = ~forwardRanksMasks[Colors::white][rank] | rankMasks[rank];
+                table[Colors::white][rank] |= Eval::rankMasks[i];
+            table[Colors::black][rank] = ~table[Colors::white][rank] | Eval::rankMasks[rank];
         }
 
+        return table;
+    }();
+
+    template<int Color>
+    static constexpr std::array<U64, 64> passedMasks() {
+        std::array<U64, 64> table{};
+
         for (int rank = 0; rank < 8; rank++) {
             for (int file = 0; file < 8; file++) {
                 int sq = rank * 8 + file;
 
-                wPassedMasks[sq] |= setFileRankMask(file - 1, -1);
-                wPassedMasks[sq] |= setFileRankMask(file, -1);
-                wPassedMasks[sq] |= setFileRankMask(file + 1, -1);
+                table[sq] = setFileRankMask(file - 1, -1) | setFileRankMask(file, -1) | setFileRankMask(file + 1, -1);
 
-                bPassedMasks[sq] = wPassedMasks[sq];
-
-                for (int i = 0; i < (8 - rank); i++) {
-                    wPassedMasks[sq] &= ~rankMasks[(7 - i) * 8 + file];
-                }
-
-                for (int i = 0; i < rank + 1; i++) {
-                    bPassedMasks[sq] &= ~rankMasks[i * 8 + file];
+                if (Color == Colors::white) {
+                    for (int i = 0; i < (8 - rank); i++) {
+                        table[sq] &= ~Eval::rankMasks[(7 - i) * 8 + file];
+                    }
+                } else {
+                    for (int i = 0; i < rank + 1; i++) {
+                        table[sq] &= ~Eval::rankMasks[i * 8 + file];
+                    }
                 }
             }
         }
+
+        return table;
     }
 
+    constexpr std::array<U64, 64> Eval::wPassedMasks = passedMasks<Colors::white>();
+    constexpr std::array<U64, 64> Eval::bPassedMasks = passedMasks<Colors::black>();
+
     const int GET_RANK[64] = {
         7, 7, 7, 7, 7, 7, 7, 7,
         6, 6, 6, 6, 6, 6, 6, 6,
@@ -205,12 +240,12 @@ namespace Sloth {
         score->scoreEndgame += scoreEndgame;
     }
 
-    static U64 occupiedOnFile(int square) {
-        return Bitboards::occupancies[both] & Eval::fileMasks[square];
+    static U64 occupiedOnFile(int square, Position& pos) {
+        return pos.occupancies[both] & Eval::fileMasks[square];
     }
 
-    static U64 occupiedOnRank(int square) {
-        return Bitboards::occupancies[both] & Eval::rankMasks[square];
+    static U64 occupiedOnRank(int square, Position& pos) {
+        return pos.occupancies[both] & Eval::rankMasks[square];
     }
 
     static int squareDistance(int sq1, int sq2) {
@@ -237,28 +272,28 @@ namespace Sloth {
     }
 
     PieceScore evaluatePawns(int piece, int square, int sideToMove, Position& pos) {
-        int doubled = Bitboards::countBits(Bitboards::bitboards[piece] & Eval::fileMasks[square]);
+        int doubled = Bitboards::countBits(pos.bitboards[piece] & Eval::fileMasks[square]);
         PieceScore score = { 0 };
 
         bool white = (piece == Piece::P);
 
-        U64* passedMask = white ? Eval::wPassedMasks : Eval::bPassedMasks;
+        const U64* passedMask = white ? Eval::wPassedMasks.data() : Eval::bPassedMasks.data();
 
         score.scoreOpening += POSITIONAL_SCORE[opening][PAWN][white ? square : MIRROR_SCORE[square]];
         score.scoreEndgame += POSITIONAL_SCORE[endgame][PAWN][white ? square : MIRROR_SCORE[square]];
 
-        U64 myPawns = Bitboards::bitboards[white ? Piece::P : Piece::p];
+        U64 myPawns = pos.bitboards[white ? Piece::P : Piece::p];
         int ourColor = white ? Colors::white : Colors::black;
 
         if (doubled > 1) {
             scorePiece(&score, (doubled - 1) * doublePawnPenaltyOpening, (doubled - 1) * doublePawnPenaltyEndgame);
         }
 
-        if ((Bitboards::bitboards[piece] & Eval::isolatedMasks[square]) == 0) {
+        if ((pos.bitboards[piece] & Eval::isolatedMasks[square]) == 0) {
             scorePiece(&score, isolatedPawnPenaltyOpening, isolatedPawnPenaltyEndgame);
         }
 
-        if ((passedMask[square] & Bitboards::bitboards[white ? Piece::p : Piece::P]) == 0) {
+        if ((passedMask[square] & pos.bitboards[white ? Piece::p : Piece::P]) == 0) {
             PieceScore eval = { 0 };
 
             U64 bitboard = pawnAdvance(1ULL << square, 0ULL, ourColor);
@@ -267,22 +302,22 @@ namespace Sloth {
 
             int dist, flag = 0;
 
-            bool canAdvance = !(bitboard & Bitboards::occupancies[Colors::both]);
+            bool canAdvance = !(bitboard & pos.occupancies[Colors::both]);
             bool safeAdvance = !(bitboard & attackedByEnemy);
 
             eval.scoreOpening += passedPawn[canAdvance][safeAdvance][rank].scoreOpening;
             eval.scoreEndgame += passedPawn[canAdvance][safeAdvance][rank].scoreEndgame;
 
-            dist = distanceBetween[square][Bitboards::getLs1bIndex(Bitboards::bitboards[white ? Piece::K : Piece::k])];
+            dist = distanceBetween[square][Bitboards::getLs1bIndex(pos.bitboards[white ? Piece::K : Piece::k])];
             eval.scoreOpening += dist * passedFriendlyDistance[rank].scoreOpening;
             eval.scoreEndgame += dist * passedFriendlyDistance[rank].scoreEndgame;
 
-            dist = distanceBetween[square][Bitboards::getLs1bIndex(Bitboards::bitboards[white ? Piece::k : Piece::K])];
+            dist = distanceBetween[square][Bitboards::getLs1bIndex(pos.bitboards[white ? Piece::k : Piece::K])];
             eval.scoreOpening += dist * passedEnemyDistance[rank].scoreOpening;
             eval.scoreEndgame += dist * passedEnemyDistance[rank].scoreEndgame;
 
             bitboard = forwardRanksMasks[ourColor][rankOf(square)] & Eval::fileMasks[fileOf(square)];
-            flag = !(bitboard & (Bitboards::occupancies[white ? Colors::black : Colors::white] | attackedByEnemy));
+            flag = !(bitboard & (pos.occupancies[white ? Colors::black : Colors::white] | attackedByEnemy));
 
             eval.scoreOpening += flag * -47;
             eval.scoreEndgame += flag * 57;
@@ -290,15 +325,15 @@ namespace Sloth {
             scorePiece(&score, eval.scoreOpening, eval.scoreEndgame);
         }
 
-        int mobility = Bitboards::countBits(~Bitboards::occupancies[Colors::both] & Bitboards::pawnAdvance(1ULL << square, 0ULL, white ? Colors::white : Colors::black));
+        int mobility = Bitboards::countBits(~pos.occupancies[Colors::both] & Bitboards::pawnAdvance(1ULL << square, 0ULL, white ? Colors::white : Colors::black));
 
         scorePiece(&score, mobility, mobility * 2);
 
-        if ((Bitboards::bitboards[piece] & backwardMasks[square]) == 0) {
+        if ((pos.bitboards[piece] & backwardMasks[square]) == 0) {
             scorePiece(&score, -4, -7);
         }
 
-        if ((Bitboards::bitboards[piece] & connectedMasks[square]) != 0) {
+        if ((pos.bitboards[piece] & connectedMasks[square]) != 0) {
             scorePiece(&score, 4, 10);
         }
 
@@ -319,7 +354,7 @@ namespace Sloth {
         return score;
     }
 
-    PieceScore evaluateRooks(int piece, int square) {
+    PieceScore evaluateRooks(int piece, int square, Position& pos) {
         PieceScore score = { 0 };
         bool white = (piece == Piece::R);
 
@@ -328,10 +363,10 @@ namespace Sloth {
         score.scoreOpening += POSITIONAL_SCORE[opening][ROOK][white ? square : MIRROR_SCORE[square]];
         score.scoreEndgame += POSITIONAL_SCORE[endgame][ROOK][white ? square : MIRROR_SCORE[square]];
 
-        U64 myPawns = Bitboards::bitboards[white ? Piece::P : Piece::p];
-        U64 enemyPawns = Bitboards::bitboards[white ? Piece::p : Piece::P];
+        U64 myPawns = pos.bitboards[white ? Piece::P : Piece::p];
+        U64 enemyPawns = pos.bitboards[white ? Piece::p : Piece::P];
 
-        U64 enemyKing = Bitboards::bitboards[white ? Piece::k : Piece::K];
+        U64 enemyKing = pos.bitboards[white ? Piece::k : Piece::K];
 
         if (!(myPawns & Eval::fileMasks[square])) {
             bool open = !(enemyPawns & Eval::fileMasks[square]);
@@ -339,17 +374,17 @@ namespace Sloth {
             scorePiece(&score, RookFile[open].scoreOpening, RookFile[open].scoreEndgame);
         }
 
-        U64 rooksOnFile = Bitboards::bitboards[piece] & Eval::fileMasks[square];
-        U64 rooksOnRank = Bitboards::bitboards[piece] & Eval::rankMasks[square];
+        U64 rooksOnFile = pos.bitboards[piece] & Eval::fileMasks[square];
+        U64 rooksOnRank = pos.bitboards[piece] & Eval::rankMasks[square];
 
         if (Bitboards::countBits(rooksOnFile) >= 2) {
-            if ((occupiedOnFile(square) & ~rooksOnFile) == 0) {
+            if ((occupiedOnFile(square, pos) & ~rooksOnFile) == 0) {
                 scorePiece(&score, doubledRooks * Bitboards::countBits(rooksOnFile), doubledRooksEndgame * Bitboards::countBits(rooksOnFile));
             }
         }
 
         if (Bitboards::countBits(rooksOnRank) >= 2) {
-            if ((occupiedOnRank(square) & ~rooksOnRank) == 0) {
+            if ((occupiedOnRank(square, pos) & ~rooksOnRank) == 0) {
                 scorePiece(&score, doubledRooks * Bitboards::countBits(rooksOnRank), doubledRooksEndgame * Bitboards::countBits(rooksOnRank));
             }
         }
@@ -357,24 +392,24 @@ namespace Sloth {
         return score;
     }
 
-    PieceScore getPieceMobility(bool bishop, int square) {
+    PieceScore getPieceMobility(bool bishop, int square, Position& pos) {
         PieceScore score = { 0 };
 
         if (bishop) {
-            score.scoreOpening += (Bitboards::countBits(Magic::getBishopAttacks(square, Bitboards::occupancies[both])) - bishopUnit) * bishopMobilityOpening;
-            score.scoreEndgame += (Bitboards::countBits(Magic::getBishopAttacks(square, Bitboards::occupancies[both])) - bishopUnit) * bishopMobilityEnd;
+            score.scoreOpening += (Bitboards::countBits(Magic::getBishopAttacks(square, pos.occupancies[both])) - bishopUnit) * bishopMobilityOpening;
+            score.scoreEndgame += (Bitboards::countBits(Magic::getBishopAttacks(square, pos.occupancies[both])) - bishopUnit) * bishopMobilityEnd;
         }
         else {
-            score.scoreOpening += (Bitboards::countBits(Magic::getQueenAttacks(square, Bitboards::occupancies[both])) - queenUnit) * queenMobilityOpening;
-            score.scoreEndgame += (Bitboards::countBits(Magic::getQueenAttacks(square, Bitboards::occupancies[both])) - queenUnit) * queenMobilityEnd;
+            score.scoreOpening += (Bitboards::countBits(Magic::getQueenAttacks(square, pos.occupancies[both])) - queenUnit) * queenMobilityOpening;
+            score.scoreEndgame += (Bitboards::countBits(Magic::getQueenAttacks(square, pos.occupancies[both])) - queenUnit) * queenMobilityEnd;
         }
 
         return score;
     }
 
-    PieceScore evaluateBishops(int piece, int square) {
+    PieceScore evaluateBishops(int piece, int square, Position& pos) {
         PieceScore score = { 0 };
-        PieceScore mobility = getPieceMobility(true, square);
+        PieceScore mobility = getPieceMobility(true, square, pos);
         bool white = (piece == Piece::B);
 
         score.scoreOpening += POSITIONAL_SCORE[opening][BISHOP][white ? square : MIRROR_SCORE[square]];
@@ -382,7 +417,7 @@ namespace Sloth {
 
         scorePiece(&score, mobility.scoreOpening, mobility.scoreEndgame);
 
-        if (testBit(pawnAdvance(Bitboards::bitboards[Piece::P] | Bitboards::bitboards[Piece::p], 0ULL, white ? Colors::black : Colors::white), square)) {
+        if (testBit(pawnAdvance(pos.bitboards[Piece::P] | pos.bitboards[Piece::p], 0ULL, white ? Colors::black : Colors::white), square)) {
             scorePiece(&score, 4, 24);
         }
 
@@ -393,9 +428,9 @@ namespace Sloth {
         return score;
     }
 
-    PieceScore evaluateQueens(int piece, int square) {
+    PieceScore evaluateQueens(int piece, int square, Position& pos) {
         PieceScore score = { 0 };
-        PieceScore mobility = getPieceMobility(false, square);
+        PieceScore mobility = getPieceMobility(false, square, pos);
         bool white = (piece == Piece::Q);
 
         score.scoreOpening += POSITIONAL_SCORE[opening][QUEEN][white ? square : MIRROR_SCORE[square]];
@@ -406,7 +441,7 @@ namespace Sloth {
         return score;
     }
 
-    PieceScore evaluateKings(int piece, int square) {
+    PieceScore evaluateKings(int piece, int square, int gamePhase, Position& pos) {
         PieceScore score = { 0 };
         bool white = (piece == Piece::K);
         int kingRank = white ? getRank(square) : GET_RANK[MIRROR_SCORE[square]];
@@ -414,25 +449,25 @@ namespace Sloth {
         score.scoreOpening += POSITIONAL_SCORE[opening][KING][white ? square : MIRROR_SCORE[square]];
         score.scoreEndgame += POSITIONAL_SCORE[endgame][KING][white ? square : MIRROR_SCORE[square]];
 
-        int myKingSq = Bitboards::getLs1bIndex(Bitboards::bitboards[white ? Piece::K : Piece::k]);
-        int theirKingSq = Bitboards::getLs1bIndex(Bitboards::bitboards[white ? Piece::k : Piece::K]);
+        int myKingSq = Bitboards::getLs1bIndex(pos.bitboards[white ? Piece::K : Piece::k]);
+        int theirKingSq = Bitboards::getLs1bIndex(pos.bitboards[white ? Piece::k : Piece::K]);
 
         int distance = squareDistance(myKingSq, theirKingSq);
 
         int distScore = 10 * (7 - distance);
 
-        if (phase.gamePhase != endgame) {
-            if ((Bitboards::bitboards[white ? Piece::P : Piece::p] & Eval::fileMasks[square]) == 0) {
+        if (gamePhase != endgame) {
+            if ((pos.bitboards[white ? Piece::P : Piece::p] & Eval::fileMasks[square]) == 0) {
                 scorePiece(&score, -semiFile, -semiFile);
             }
 
-            if (((Bitboards::bitboards[Piece::P] | Bitboards::bitboards[Piece::p]) & Eval::fileMasks[square]) == 0) {
+            if (((pos.bitboards[Piece::P] | pos.bitboards[Piece::p]) & Eval::fileMasks[square]) == 0) {
                 scorePiece(&score, -openFile, -openFile);
             }
 
             if (kingRank == 0) {
                 U64 pawnSquares = white ? (square % 8 < 3 ? 0x007000000000000ULL : 0x000E0000000000000ULL) : (square % 8 < 3 ? 0x700 : 0xE000);
-                U64 pawns = Bitboards::bitboards[white ? Piece::P : Piece::p] & pawnSquares;
+                U64 pawns = pos.bitboards[white ? Piece::P : Piece::p] & pawnSquares;
                 PieceScore shieldScores = pawnShield[std::min(Bitboards::countBits(pawns), 3)];
 
                 scorePiece(&score, shieldScores.scoreOpening, shieldScores.scoreEndgame);
@@ -457,33 +492,33 @@ namespace Sloth {
         return score;
     }
 
-    static int getGamePhaseScore() {
+    static int getGamePhaseScore(Position& pos) {
         int w = 0;
         int b = 0;
 
         for (int p = Piece::N; p <= Piece::Q; p++)
-            w += Bitboards::countBits(Bitboards::bitboards[p]) * materialScore[opening][p];
+            w += Bitboards::countBits(pos.bitboards[p]) * materialScore[opening][p];
 
         for (int p = Piece::n; p <= Piece::q; p++)
-            b += Bitboards::countBits(Bitboards::bitboards[p]) * -materialScore[opening][p];
+            b += Bitboards::countBits(pos.bitboards[p]) * -materialScore[opening][p];
 
         return w + b;
     }
 
     bool isDraw(Position& pos) {
-        if (Bitboards::countBits(Bitboards::occupancies[Colors::both]) < 5) {
-            if ((Bitboards::occupancies[Colors::both] & ~(Bitboards::bitboards[Piece::K] | Bitboards::bitboards[Piece::k])) == 0) {
+        if (Bitboards::countBits(pos.occupancies[Colors::both]) < 5) {
+            if ((pos.occupancies[Colors::both] & ~(pos.bitboards[Piece::K] | pos.bitboards[Piece::k])) == 0) {
                 return true;
             }
         }
 
-        int pawns = Bitboards::countBits(Bitboards::bitboards[Piece::P] | Bitboards::bitboards[Piece::p]);
-        int wKnights = Bitboards::countBits(Bitboards::bitboards[Piece::N]);
-        int bKnights = Bitboards::countBits(Bitboards::bitboards[Piece::n]);
-        int wBishops = Bitboards::countBits(Bitboards::bitboards[Piece::B]);
-        int bBishops = Bitboards::countBits(Bitboards::bitboards[Piece::b]);
-        int rooks = Bitboards::countBits(Bitboards::bitboards[Piece::R] | Bitboards::bitboards[Piece::r]);
-        int queens = Bitboards::countBits(Bitboards::bitboards[Piece::Q] | Bitboards::bitboards[Piece::q]);
+        int pawns = Bitboards::countBits(pos.bitboards[Piece::P] | pos.bitboards[Piece::p]);
+        int wKnights = Bitboards::countBits(pos.bitboards[Piece::N]);
+        int bKnights = Bitboards::countBits(pos.bitboards[Piece::n]);
+        int wBishops = Bitboards::countBits(pos.bitboards[Piece::B]);
+        int bBishops = Bitboards::countBits(pos.bitboards[Piece::b]);
+        int rooks = Bitboards::countBits(pos.bitboards[Piece::R] | pos.bitboards[Piece::r]);
+        int queens = Bitboards::countBits(pos.bitboards[Piece::Q] | pos.bitboards[Piece::q]);
 
         int minors = wKnights + bKnights + wBishops + bBishops;
 
@@ -498,16 +533,16 @@ namespace Sloth {
         }
 
         if (minors + pawns == 0
-            && ((queens == 0 && Bitboards::countBits(Bitboards::bitboards[Piece::R]) + Bitboards::countBits(Bitboards::bitboards[Piece::r]) == 2)
-            || (rooks == 0 && Bitboards::countBits(Bitboards::bitboards[Piece::Q]) + Bitboards::countBits(Bitboards::bitboards[Piece::q]) == 2))) {
+            && ((queens == 0 && Bitboards::countBits(pos.bitboards[Piece::R]) + Bitboards::countBits(pos.bitboards[Piece::r]) == 2)
+            || (rooks == 0 && Bitboards::countBits(pos.bitboards[Piece::Q]) + Bitboards::countBits(pos.bitboards[Piece::q]) == 2))) {
             return true;
         }
 
         return false;
     }
 
-    bool Eval::isEndgame() {
-        int phaseScore = getGamePhaseScore();
+    bool Eval::isEndgame(Position& pos) {
+        int phaseScore = getGamePhaseScore(pos);
 
         return phaseScore < endgameScore;
     }
@@ -517,11 +552,16 @@ namespace Sloth {
 
 
 int Sloth::Eval::evaluate(Position& pos) {
-    scores.score = 0;
-    scores.scoreEndgame = 0;
-    scores.scoreOpening = 0;
+    struct {
+        int gamePhase = -1;
+        int phaseScore;
+    } phase;
+
+    struct {
+        int score = 0, scoreOpening = 0, scoreEndgame = 0;
+    } scores;
 
-    phase.phaseScore = getGamePhaseScore();
+    phase.phaseScore = getGamePhaseScore(pos);
 
     if (phase.phaseScore > openingScore)
         phase.gamePhase = opening;
@@ -541,7 +581,7 @@ int Sloth::Eval::evaluate(Position& pos) {
     }
 
     for (int bbPiece = Piece::P; bbPiece <= Piece::k; bbPiece++) {
-        bb = Bitboards::bitboards[bbPiece];
+        bb = pos.bitboards[bbPiece];
 
         while (bb) {
             piece = bbPiece;
@@ -562,22 +602,22 @@ int Sloth::Eval::evaluate(Position& pos) {
                     scores.scoreEndgame += N.scoreEndgame;
                     break;
                 case Piece::B:
-                    B = evaluateBishops(Piece::B, square);
+                    B = evaluateBishops(Piece::B, square, pos);
                     scores.scoreOpening += B.scoreOpening;
                     scores.scoreEndgame += B.scoreEndgame;
                     break;
                 case Piece::R:
-                    R = evaluateRooks(Piece::R, square);
+                    R = evaluateRooks(Piece::R, square, pos);
                     scores.scoreOpening += R.scoreOpening;
                     scores.scoreEndgame += R.scoreEndgame;
                     break;
                 case Piece::Q:
-                    Q = evaluateQueens(Piece::Q, square);
+                    Q = evaluateQueens(Piece::Q, square, pos);
                     scores.scoreOpening += Q.scoreOpening;
                     scores.scoreEndgame += Q.scoreEndgame;
                     break;
                 case Piece::K:
-                    K = evaluateKings(Piece::K, square);
+                    K = evaluateKings(Piece::K, square, phase.gamePhase, pos);
                     scores.scoreOpening += K.scoreOpening;
                     scores.scoreEndgame += K.scoreEndgame;
                     break;
@@ -592,22 +632,22 @@ int Sloth::Eval::evaluate(Position& pos) {
                     scores.scoreEndgame -= n.scoreEndgame;
                     break;
                 case Piece::b:
-                    b = evaluateBishops(Piece::b, square);
+                    b = evaluateBishops(Piece::b, square, pos);
                     scores.scoreOpening -= b.scoreOpening;
                     scores.scoreEndgame -= b.scoreEndgame;
                     break;
                 case Piece::r:
-                    r = evaluateRooks(Piece::r, square);
+                    r = evaluateRooks(Piece::r, square, pos);
                     scores.scoreOpening -= r.scoreOpening;
                     scores.scoreEndgame -= r.scoreEndgame;
                     break;
                 case Piece::q:
-                    q = evaluateQueens(Piece::q, square);
+                    q = evaluateQueens(Piece::q, square, pos);
                     scores.scoreOpening -= q.scoreOpening;
                     scores.scoreEndgame -= q.scoreEndgame;
                     break;
                 case Piece::k:
-                    k = evaluateKings(Piece::k, square);
+                    k = evaluateKings(Piece::k, square, phase.gamePhase, pos);
                     scores.scoreOpening -= k.scoreOpening;
                     scores.scoreEndgame -= k.scoreEndgame;
                     break;
@@ -8,18 +8,16 @@ namespace Sloth {
     namespace Eval {
         enum PieceTypes { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING, NB_PIECE };
 
-        extern U64 fileMasks[64];
-        extern U64 rankMasks[64];
+        // built by the compiler, see evaluate.cpp
+        extern const std::array<U64, 64> fileMasks;
+        extern const std::array<U64, 64> rankMasks;
 
-        extern U64 isolatedMasks[64]; // isolated pawns
-        extern U64 wPassedMasks[64]; // white passed pawns
-        extern U64 bPassedMasks[64]; // black
+        extern const std::array<U64, 64> isolatedMasks; // isolated pawns
+        extern const std::array<U64, 64> wPassedMasks; // white passed pawns
+        extern const std::array<U64, 64> bPassedMasks; // black
         extern U64 orgthogonalDistance[64][64];
 
-        U64 setFileRankMask(int fileNum, int rankNum);
-        void initEvalMasks();
-
-        extern  bool isEndgame();
+        extern  bool isEndgame(Position& pos);
         extern  int evaluate(Position& pos);
     }
 }
@@ -1,9 +1,11 @@
+#include "bench.cpp"
 #include "bitboards.cpp"
 #include "evaluate.cpp"
 #include "magic.cpp"
 #include "main.cpp"
 //#include "misc.cpp"
 #include "movegen.cpp"
+#include "movepick.cpp"
 #include "perft.cpp"
 #include "piece.cpp"
 #include "position.cpp"
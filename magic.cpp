@@ -1,20 +1,24 @@
 #include <iostream>
 #include <string.h>
+#include <chrono>
+#include <array>
+#include <bit>
+#include <algorithm>
+#include <utility>
 
 #include "magic.h"
 #include "bitboards.h"
 #include "piece.h"
+#include "types.h"
 
-namespace Sloth {
-    U64 Magic::bishopMasks[64];
-    U64 Magic::rookMasks[64];
-
-    U64 Magic::bishopAttacks[64][512];
-    U64 Magic::rookAttacks[64][4096];
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
 
+namespace Sloth {
     //U64 Magic::bishopMagics[64];
 
-	U64 Magic::maskBishopAttacks(int square) {
+	static constexpr U64 maskBishopAttacks(int square) {
 		U64 attacks = 0ULL;
 
 		int rank, file;
@@ -30,7 +34,7 @@ namespace Sloth {
 		return attacks;
 	}
 
-	U64 Magic::maskRookAttacks(int square) {
+	static constexpr U64 maskRookAttacks(int square) {
 		U64 attacks = 0ULL;
 
 		int r, f;
@@ -45,114 +49,73 @@ namespace Sloth {
 		return attacks;
 	}
 
-    // generate bishop attacks on the fly
-    U64 bishopAttacksOnTheFly(int square, U64 block)
-    {
-        U64 attacks = 0ULL;
+    // rays from a square to the edge of the board, the square itself excluded
+    enum RayDirection { NORTH, SOUTH, EAST, WEST, NORTH_EAST, NORTH_WEST, SOUTH_EAST, SOUTH_WEST };
 
-        int r, f;
+    constexpr int RAY_RANK_STEP[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    constexpr int RAY_FILE_STEP[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
 
-        int tr = square / 8;
-        int tf = square % 8;
+    static constexpr std::array<std::array<U64, 64>, 8> rays = [] {
+        std::array<std::array<U64, 64>, 8> table{};
 
-        for (r = tr + 1, f = tf + 1; r <= 7 && f <= 7; r++, f++)
-        {
-            attacks |= (1ULL << (r * 8 + f));
-            if ((1ULL << (r * 8 + f)) & block) break;
+        for (int direction = 0; direction < 8; direction++) {
+            for (int square = 0; square < 64; square++) {
+                for (int r = square / 8 + RAY_RANK_STEP[direction], f = square % 8 + RAY_FILE_STEP[direction];
+                    r >= 0 && r <= 7 && f >= 0 && f <= 7; r += RAY_RANK_STEP[direction], f += RAY_FILE_STEP[direction]) {
+                    table[direction][square] |= (1ULL << (r * 8 + f));
+                }
+            }
         }
 
-        for (r = tr - 1, f = tf + 1; r >= 0 && f <= 7; r--, f++)
-        {
-            attacks |= (1ULL << (r * 8 + f));
-            if ((1ULL << (r * 8 + f)) & block) break;
-        }
+        return table;
+    }();
 
-        for (r = tr + 1, f = tf - 1; r <= 7 && f >= 0; r++, f--)
-        {
-            attacks |= (1ULL << (r * 8 + f));
-            if ((1ULL << (r * 8 + f)) & block) break;
-        }
+    // the ray up to and including its first blocker: everything behind the blocker is its own ray in the same direction
+    static constexpr U64 rayAttacks(int direction, int square, U64 block) {
+        U64 attacks = rays[direction][square];
+        U64 blockers = attacks & block;
+
+        if (blockers) {
+            // towards a8 the nearest blocker is the highest square, towards h1 the lowest
+            int blocker = (direction == NORTH || direction == WEST || direction == NORTH_EAST || direction == NORTH_WEST) ? 63 - std::countl_zero(blockers) : std::countr_zero(blockers);
 
-        for (r = tr - 1, f = tf - 1; r >= 0 && f >= 0; r--, f--)
-        {
-            attacks |= (1ULL << (r * 8 + f));
-            if ((1ULL << (r * 8 + f)) & block) break;
+            attacks ^= rays[direction][blocker];
         }
 
         return attacks;
     }
 
-    // generate rook attacks on the fly
-    U64 rookAttacksOnTheFly(int square, U64 block)
+    // generate bishop attacks on the fly
+    static constexpr U64 bishopAttacksOnTheFly(int square, U64 block)
     {
-        U64 attacks = 0ULL;
-
-        int r, f;
-
-        int tr = square / 8;
-        int tf = square % 8;
-
-        for (r = tr + 1; r <= 7; r++)
-        {
-            attacks |= (1ULL << (r * 8 + tf));
-            if ((1ULL << (r * 8 + tf)) & block) break;
-        }
-
-        for (r = tr - 1; r >= 0; r--)
-        {
-            attacks |= (1ULL << (r * 8 + tf));
-            if ((1ULL << (r * 8 + tf)) & block) break;
-        }
-
-        for (f = tf + 1; f <= 7; f++)
-        {
-            attacks |= (1ULL << (tr * 8 + f));
-            if ((1ULL << (tr * 8 + f)) & block) break;
-        }
-
-        for (f = tf - 1; f >= 0; f--)
-        {
-            attacks |= (1ULL << (tr * 8 + f));
-            if ((1ULL << (tr * 8 + f)) & block) break;
-        }
+        return rayAttacks(NORTH_EAST, square, block) | rayAttacks(NORTH_WEST, square, block) | rayAttacks(SOUTH_EAST, square, block) | rayAttacks(SOUTH_WEST, square, block);
+    }
 
-        return attacks;
+    // generate rook attacks on the fly
+    static constexpr U64 rookAttacksOnTheFly(int square, U64 block)
+    {
+        return rayAttacks(NORTH, square, block) | rayAttacks(SOUTH, square, block) | rayAttacks(EAST, square, block) | rayAttacks(WEST, square, block);
     }
 
 
     unsigned int Magic::getRandomU32Num() {
-        unsigned int num = randomState;
-
-        num ^= num << 13;
-        num ^= num >> 17;
-        num ^= num << 5;
-
-        randomState = num;
-
-        return num;
+        return nextRandomU32(randomState);
     }
 
     U64 Magic::getRandomU64Num() {
-        U64 n1, n2, n3, n4;
-
-        n1 = (U64)(getRandomU32Num() & 0xFFFF);
-        n2 = (U64)(getRandomU32Num() & 0xFFFF);
-        n3 = (U64)(getRandomU32Num() & 0xFFFF);
-        n4 = (U64)(getRandomU32Num() & 0xFFFF);
-
-        return n1 | (n2 << 16) | (n3 << 32) | (n4 << 48); // shuffle bits
+        return nextRandomU64(randomState);
     }
 
     U64 Magic::generateMagicNumber() {
         return getRandomU64Num() & getRandomU64Num() & getRandomU64Num();
     }
 
-	U64 Magic::setOccupancy(int index, int bitsInMask, U64 attackMask) {
+	static constexpr U64 setOccupancy(int index, int bitsInMask, U64 attackMask) {
 		U64 occupancy = 0ULL;
 
 		// loop over range of bits within attack mask
 		for (int c = 0; c < bitsInMask; c++) {
-			int square = Bitboards::getLs1bIndex(attackMask);
+			int square = std::countr_zero(attackMask);
 
 			// pop LS1B in the attack map
 			popBit(attackMask, square);
@@ -220,51 +183,88 @@ namespace Sloth {
         return 0ULL;
 	}
 
-    void Magic::initSlidersAttacks(int bishop) {
-        for (int square = 0; square < 64; square++) {
-            // init bishop & rook masks
-            bishopMasks[square] = maskBishopAttacks(square);
-            rookMasks[square] = maskRookAttacks(square);
+    // the attacks of one square for each of its relevant occupancies. Every square is its own constant evaluation,
+    // which keeps the work per evaluation well inside the compilers' default step limits
+    template<int Bishop, int Square>
+    static constexpr auto squareAttacks = [] {
+        constexpr int relevantBits = Bishop ? Magic::BISHOP_RELEVANT_BITS[Square] : Magic::ROOK_RELEVANT_BITS[Square];
+        constexpr U64 mask = Bishop ? maskBishopAttacks(Square) : maskRookAttacks(Square);
+
+        std::array<U64, (1 << relevantBits)> table{};
+        U64 occupancy = 0ULL;
+
+        // walks the subsets of the mask in the order setOccupancy numbers them, one step each
+        for (int i = 0; i < (1 << relevantBits); i++, occupancy = (occupancy - mask) & mask) {
+#ifdef USE_PEXT
+            // pext packs the occupancy bits of the mask in order, which is exactly the index they were set from
+            int index = i;
+#else
+            U64 magic = Bishop ? Magic::bishopMagics[Square] : Magic::rookMagics[Square];
+            int index = (int)((occupancy * magic) >> (64 - relevantBits));
+#endif
+
+            table[index] = Bishop ? bishopAttacksOnTheFly(Square, occupancy) : rookAttacksOnTheFly(Square, occupancy);
+        }
 
-            U64 attackMask = bishop ? bishopMasks[square] : rookMasks[square];
+        return table;
+    }();
 
-            int relevantBits = Bitboards::countBits(attackMask);
-            int occupancyIndicies = (1 << relevantBits);
+    // every square's attacks packed back to back in square order
+    template<int Bishop, int TableSize, std::size_t... Squares>
+    static constexpr std::array<U64, TableSize> buildAttackTable(std::index_sequence<Squares...>) {
+        std::array<U64, TableSize> table{};
+        int offset = 0;
 
-            for (int i = 0; i < occupancyIndicies; i++) {
-                if (bishop) {
-                    U64 occupancy = setOccupancy(i, relevantBits, attackMask);
+        ((std::copy(squareAttacks<Bishop, Squares>.begin(), squareAttacks<Bishop, Squares>.end(), table.begin() + offset),
+            offset += (int)squareAttacks<Bishop, Squares>.size()), ...);
 
-                    // init magic index
-                    int magicIndex = (occupancy * bishopMagics[square]) >> (64 - BISHOP_RELEVANT_BITS[square]);
+        return table;
+    }
 
-                    bishopAttacks[square][magicIndex] = bishopAttacksOnTheFly(square, occupancy);
-                }
-                else {
-                    U64 occupancy = setOccupancy(i, relevantBits, attackMask);
-                    int magicIndex = (occupancy * rookMagics[square]) >> (64 - ROOK_RELEVANT_BITS[square]);
+    template<int Bishop>
+    static constexpr std::array<Magic::SquareMagic, 64> buildSquareMagics(const U64* attacks) {
+        std::array<Magic::SquareMagic, 64> entries{};
 
-                    rookAttacks[square][magicIndex] = rookAttacksOnTheFly(square, occupancy);
-                }
-            }
+        for (int square = 0; square < 64; square++) {
+            int relevantBits = Bishop ? Magic::BISHOP_RELEVANT_BITS[square] : Magic::ROOK_RELEVANT_BITS[square];
+
+            entries[square].mask = Bishop ? maskBishopAttacks(square) : maskRookAttacks(square);
+            entries[square].magic = Bishop ? Magic::bishopMagics[square] : Magic::rookMagics[square];
+            entries[square].shift = 64 - relevantBits;
+            entries[square].attacks = attacks;
+
+            attacks += (1 << relevantBits);
         }
+
+        return entries;
     }
-    
+
+    // computed while compiling, so the slider tables are read-only data shared by every running engine
+    constexpr std::array<U64, Magic::BISHOP_TABLE_SIZE> Magic::bishopAttacks = buildAttackTable<Piece::bishop, BISHOP_TABLE_SIZE>(std::make_index_sequence<64>());
+    constexpr std::array<U64, Magic::ROOK_TABLE_SIZE> Magic::rookAttacks = buildAttackTable<Piece::rook, ROOK_TABLE_SIZE>(std::make_index_sequence<64>());
+
+    constexpr std::array<Magic::SquareMagic, 64> Magic::bishops = buildSquareMagics<Piece::bishop>(Magic::bishopAttacks.data());
+    constexpr std::array<Magic::SquareMagic, 64> Magic::rooks = buildSquareMagics<Piece::rook>(Magic::rookAttacks.data());
+
     // everything self explanatory
      U64 Magic::getBishopAttacks(int square, U64 occupancy) {
-        occupancy &= bishopMasks[square];
-        occupancy *= bishopMagics[square];
-        occupancy >>= 64 - BISHOP_RELEVANT_BITS[square];
+        const SquareMagic& entry = bishops[square];
 
-        return bishopAttacks[square][occupancy];
+#ifdef USE_PEXT
+        return entry.attacks[_pext_u64(occupancy, entry.mask)];
+#else
+        return entry.attacks[((occupancy & entry.mask) * entry.magic) >> entry.shift];
+#endif
     }
 
      U64 Magic::getRookAttacks(int square, U64 occupancy) {
-        occupancy &= rookMasks[square];
-        occupancy *= rookMagics[square];
-        occupancy >>= 64 - ROOK_RELEVANT_BITS[square];
+        const SquareMagic& entry = rooks[square];
 
-        return rookAttacks[square][occupancy];
+#ifdef USE_PEXT
+        return entry.attacks[_pext_u64(occupancy, entry.mask)];
+#else
+        return entry.attacks[((occupancy & entry.mask) * entry.magic) >> entry.shift];
+#endif
     }
 
      U64 Magic::getQueenAttacks(int square, U64 occupancy) {
@@ -274,9 +274,39 @@ namespace Sloth {
         return (bishopAttacks | rookAttacks);
     }
 
-    void Magic::initAttacks() {
-        initSlidersAttacks(Piece::bishop);
-        initSlidersAttacks(Piece::rook);
+    // times slider lookups on random occupancies, build with and without USE_PEXT to compare the two indexings
+    void Magic::benchmarkSliders() {
+        const int occupancyCount = 4096;
+        const int rounds = 200;
+
+        static U64 occupancies[occupancyCount];
+
+        for (int i = 0; i < occupancyCount; i++) occupancies[i] = getRandomU64Num() & getRandomU64Num();
+
+        U64 sum = 0ULL;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < occupancyCount; i++) {
+                U64 occupancy = occupancies[i] ^ sum;
+
+                for (int square = 0; square < 64; square++) {
+                    sum += getBishopAttacks(square, occupancy) ^ getRookAttacks(square, occupancy);
+                }
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double lookups = 2.0 * rounds * occupancyCount * 64;
+
+#ifdef USE_PEXT
+        const char* indexing = "pext";
+#else
+        const char* indexing = "magic";
+#endif
+
+        printf("%s slider lookups: %.0f in %.0f ms, %.1fM lookups/s (checksum %llx)\n", indexing, lookups, seconds * 1000, lookups / seconds / 1000000, (unsigned long long)sum);
     }
 
     void Magic::initMagicNumbers() {
@@ -287,16 +317,13 @@ namespace Sloth {
         }*/
 
         for (int square = 0; square < 64; square++) {
-            rookMagics[square] = findMagicNumber(square, ROOK_RELEVANT_BITS[square], Piece::rook);
-            //printf(" 0x%llxULL,\n", findMagicNumber(square, ROOK_RELEVANT_BITS[square], Piece::rook));
+            printf(" 0x%llxULL,\n", (unsigned long long)findMagicNumber(square, ROOK_RELEVANT_BITS[square], Piece::rook));
         }
 
-        //std::cout << std::endl;
+        std::cout << std::endl;
 
         for (int square = 0; square < 64; square++) {
-            bishopMagics[square] = findMagicNumber(square, BISHOP_RELEVANT_BITS[square], Piece::bishop);
-
-            //printf(" 0x%llxULL,\n", findMagicNumber(square, BISHOP_RELEVANT_BITS[square], Piece::bishop));
+            printf(" 0x%llxULL,\n", (unsigned long long)findMagicNumber(square, BISHOP_RELEVANT_BITS[square], Piece::bishop));
         }
     }
 }
\ No newline at end of file
@@ -5,13 +5,26 @@
 
 namespace Sloth {
     namespace Magic {
-        extern U64 bishopMasks[64];
-        extern U64 rookMasks[64];
+        // what a slider lookup needs for one square, 32 bytes so that it never straddles a cache line
+        struct alignas(32) SquareMagic {
+            U64 mask; // relevant occupancy
+            U64 magic;
+            const U64* attacks; // the part of the packed table that belongs to this square
+            int shift;
+        };
+
+        // built by the compiler, see magic.cpp
+        extern const std::array<SquareMagic, 64> bishops;
+        extern const std::array<SquareMagic, 64> rooks;
 
-        extern U64 bishopAttacks[64][512]; // [square][occupancies]
-        extern U64 rookAttacks[64][4096];
+        // attacks of every square packed back to back, each square takes 2^relevant bits entries
+        constexpr int BISHOP_TABLE_SIZE = 5248;
+        constexpr int ROOK_TABLE_SIZE = 102400;
 
-        const int BISHOP_RELEVANT_BITS[64] = {
+        extern const std::array<U64, BISHOP_TABLE_SIZE> bishopAttacks;
+        extern const std::array<U64, ROOK_TABLE_SIZE> rookAttacks;
+
+        constexpr int BISHOP_RELEVANT_BITS[64] = {
             6, 5, 5, 5, 5, 5, 5, 6,
             5, 5, 5, 5, 5, 5, 5, 5,
             5, 5, 7, 7, 7, 7, 5, 5,
@@ -22,7 +35,7 @@ namespace Sloth {
             6, 5, 5, 5, 5, 5, 5, 6,
         };
 
-        const int ROOK_RELEVANT_BITS[64] = {
+        constexpr int ROOK_RELEVANT_BITS[64] = {
             12, 11, 11, 11, 11, 11, 11, 12,
             11, 10, 10, 10, 10, 10, 10, 11,
             11, 10, 10, 10, 10, 10, 10, 11,
@@ -36,7 +49,7 @@ namespace Sloth {
 
         // DEFINE MAGIC NUMBERS
 
-        static U64 rookMagics[64] = {
+        constexpr U64 rookMagics[64] = {
             0xa080041440042080ULL,
             0xc0200040001000ULL,
             0x180200081100008ULL,
@@ -103,7 +116,7 @@ namespace Sloth {
             0x410008024010042ULL,
         };
 
-        static U64 bishopMagics[64] = { // UPDATED BISHOP MAGICS
+        constexpr U64 bishopMagics[64] = { // UPDATED BISHOP MAGICS
             0x40040844404084ULL,
             0x2004208a004208ULL,
             0x10190041080202ULL,
@@ -170,27 +183,41 @@ namespace Sloth {
             0x4010011029020020ULL
         };
 
-        static unsigned int randomState = 1804289383; // psuedo random number state
+        constexpr unsigned int RANDOM_SEED = 1804289383;
+
+        static unsigned int randomState = RANDOM_SEED; // psuedo random number state
 
-        U64 maskBishopAttacks(int square);
-        U64 maskRookAttacks(int square);
-        U64 setOccupancy(int index, int bitsInMask, U64 attackMask);
+        // xorshift step, usable by the compiler so that the zobrist keys can be built as constants
+        constexpr unsigned int nextRandomU32(unsigned int& state) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            return state;
+        }
+
+        constexpr U64 nextRandomU64(unsigned int& state) {
+            U64 n1 = (U64)(nextRandomU32(state) & 0xFFFF);
+            U64 n2 = (U64)(nextRandomU32(state) & 0xFFFF);
+            U64 n3 = (U64)(nextRandomU32(state) & 0xFFFF);
+            U64 n4 = (U64)(nextRandomU32(state) & 0xFFFF);
+
+            return n1 | (n2 << 16) | (n3 << 32) | (n4 << 48); // shuffle bits
+        }
 
         unsigned int getRandomU32Num();
 
         U64 getRandomU64Num();
         U64 generateMagicNumber();
 
-        void initSlidersAttacks(int bishop);
-
         extern  U64 getBishopAttacks(int square, U64 occupancy);
         extern  U64 getRookAttacks(int square, U64 occupancy);
         extern  U64 getQueenAttacks(int square, U64 occupancy);
 
-        void initAttacks();
+        void benchmarkSliders();
 
         U64 findMagicNumber(int square, int relevantBits, int bishop);
-        void initMagicNumbers();
+        void initMagicNumbers(); // searches new magics and prints them in the form of the tables above
     }
 }
 #endif
\ No newline at end of file
@@ -24,21 +24,26 @@
 #include "uci.h"
 #include "search.h"
 #include "evaluate.h"
+#include "bench.h"
 
 using namespace Sloth;
 
 int main(int argc, char* argv[])
 {
-    Magic::initAttacks();
-    Bitboards::initLeaperAttacks();
-    Zobrist::initRandomKeys();
+    // attack, mask and key tables are built by the compiler, only the hash table is allocated at startup
     Search::initHashTable(64);
-    Eval::initEvalMasks();
     //game.parseFen(startPosition);
 
     bool debug = false;
 
-    if (debug) {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        // sloth bench [depth] [hash] [threads]
+        std::string args;
+
+        for (int i = 2; i < argc; i++) args += std::string(" ") + argv[i];
+
+        Bench::benchCommand(args, false);
+    } else if (debug) {
         Position pos;
 
         Movegen::MoveList movelist[1];
@@ -48,7 +53,7 @@ int main(int argc, char* argv[])
         pos.printBoard();
     } else UCI::loop();
 
-    my_free(Search::hashTable);
+    my_aligned_free(Search::hashTable);
 
     return 0;
 }
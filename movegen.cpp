@@ -34,19 +34,19 @@ namespace Sloth {
 		{Piece::n, 'n'}
 	};
 
-	void Movegen::printMove(int move) {
+	void Movegen::printMove(Move move) {
 		if (getMovePromotion(move)) {
-			Piece::Pieces promotion = static_cast<Piece::Pieces>(getMovePromotion(move));
+			Piece::Pieces promotion = static_cast<Piece::Pieces>(getPromotionPiece(move));
 			printf("%s%s%c", squareToCoordinates[getMoveSource(move)], squareToCoordinates[getMoveTarget(move)], promotedPieces[promotion]);
 		} else {
 			printf("%s%s", squareToCoordinates[getMoveSource(move)], squareToCoordinates[getMoveTarget(move)]);
 		}
 	}
 
-	std::string Movegen::moveToString(int move) {
+	std::string Movegen::moveToString(Move move) {
 		std::stringstream ss;
 		if (getMovePromotion(move)) {
-			Piece::Pieces promotion = static_cast<Piece::Pieces>(getMovePromotion(move));
+			Piece::Pieces promotion = static_cast<Piece::Pieces>(getPromotionPiece(move));
 			ss << squareToCoordinates[getMoveSource(move)]
 				<< squareToCoordinates[getMoveTarget(move)]
 				<< promotedPieces[promotion];
@@ -62,269 +62,380 @@ namespace Sloth {
 			printf("\n	No moves in the move list");
 			return;
 		}
-		printf("\nmove  piece capture double enpassant castling\n\n");
+		printf("\nmove  flags capture double enpassant castling\n\n");
 		for (int c = 0; c < moveList->count; c++) {
-			int move = moveList->moves[c];
-			Piece::Pieces promotion = static_cast<Piece::Pieces>(getMovePromotion(move));
-			printf("%s%s%c %c     %d	     %d  	%d	   %d\n", squareToCoordinates[getMoveSource(move)], squareToCoordinates[getMoveTarget(move)], getMovePromotion(move) ? promotedPieces[promotion] : ' ',
-				Piece::asciiPieces[getMovePiece(move)], getMoveCapture(move) ? 1 : 0, getDoublePush(move) ? 1 : 0, getMoveEnpassant(move) ? 1 : 0, getMoveCastling(move) ? 1 : 0);
+			Move move = moveList->moves[c];
+			Piece::Pieces promotion = static_cast<Piece::Pieces>(getPromotionPiece(move));
+			printf("%s%s%c %2d     %d	     %d  	%d	   %d\n", squareToCoordinates[getMoveSource(move)], squareToCoordinates[getMoveTarget(move)], getMovePromotion(move) ? promotedPieces[promotion] : ' ',
+				getMoveFlags(move), getMoveCapture(move) ? 1 : 0, getDoublePush(move) ? 1 : 0, getMoveEnpassant(move) ? 1 : 0, getMoveCastling(move) ? 1 : 0);
 		}
 		printf("\n\nNumber of moves: %d\n\n", moveList->count);
 	}
 
-	void Movegen::generateMoves(Position& pos, MoveList* moveList, bool captures) {
-		moveList->count = 0;
-		int sourceSquare, target;
-		U64 bb, attacks;
-
-		for (int piece = Piece::P; piece <= Piece::k; piece++) {
-			bb = Bitboards::bitboards[piece];
-			if (pos.sideToMove == Colors::white) {
-				if (piece == Piece::P) {
-					while (bb) {
-						sourceSquare = Bitboards::getLs1bIndex(bb);
-						target = sourceSquare - 8;
-						if (!(target < a8) && !getBit(Bitboards::occupancies[both], target)) {
-							if (captures && sourceSquare >= a7 && sourceSquare <= h7) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::Q, 0, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::R, 0, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::B, 0, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::N, 0, 0, 0, 0));
-							} else {
-								if (sourceSquare >= a7 && sourceSquare <= h7) {
-									addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::Q, 0, 0, 0, 0));
-									addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::R, 0, 0, 0, 0));
-									addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::B, 0, 0, 0, 0));
-									addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::N, 0, 0, 0, 0));
-								} else {
-									addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 0, 0, 0, 0));
-									if ((sourceSquare >= a2 && sourceSquare <= h2) && !getBit(Bitboards::occupancies[both], (target - 8))) {
-										addMove(moveList, encodeMove(sourceSquare, (target - 8), piece, 0, 0, 1, 0, 0));
-									}
-								}
-							}
-						}
-						U64 pawnLookup = Bitboards::pawnAttacks[pos.sideToMove][sourceSquare];
-						attacks = pawnLookup & Bitboards::occupancies[Colors::black];
-						while (attacks) {
-							target = Bitboards::getLs1bIndex(attacks);
-							if (sourceSquare >= a7 && sourceSquare <= h7) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::Q, 1, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::R, 1, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::B, 1, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::N, 1, 0, 0, 0));
-							} else {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-							popBit(attacks, target);
-						}
-						if (pos.enPassant != no_sq) {
-							U64 enPassantAttacks = Bitboards::pawnAttacks[pos.sideToMove][sourceSquare] & (1ULL << pos.enPassant);
-							if (enPassantAttacks) {
-								int targetEnPassant = Bitboards::getLs1bIndex(enPassantAttacks);
-								addMove(moveList, encodeMove(sourceSquare, targetEnPassant, piece, 0, 1, 0, 1, 0));
-							}
-						}
-						popBit(bb, sourceSquare);
-					}
-				}
-				if (!captures) {
-					if (piece == Piece::K) {
-						if (pos.castle & CastlingRights::WK) {
-							if (!getBit(Bitboards::occupancies[Colors::both], f1) && !getBit(Bitboards::occupancies[Colors::both], g1)) {
-								if (!pos.isSquareAttacked(e1, Colors::black) && !pos.isSquareAttacked(f1, Colors::black)) {
-									addMove(moveList, encodeMove(e1, g1, piece, 0, 0, 0, 0, 1));
-								}
-							}
-						}
-						if (pos.castle & CastlingRights::WQ) {
-							if (!getBit(Bitboards::occupancies[Colors::both], d1) && !getBit(Bitboards::occupancies[Colors::both], c1) && !getBit(Bitboards::occupancies[Colors::both], b1)) {
-								if (!pos.isSquareAttacked(e1, Colors::black) && !pos.isSquareAttacked(d1, Colors::black)) {
-									addMove(moveList, encodeMove(e1, c1, piece, 0, 0, 0, 0, 1));
-								}
-							}
-						}
-					}
-				}
-			} else {
-				if (piece == Piece::p) {
-					while (bb) {
-						sourceSquare = Bitboards::getLs1bIndex(bb);
-						target = sourceSquare + 8;
-						if (!(target > h1) && !getBit(Bitboards::occupancies[both], target)) {
-							if (captures && sourceSquare >= a2 && sourceSquare <= h2) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::q, 0, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::r, 0, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::b, 0, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::n, 0, 0, 0, 0));
-							} else {
-								if (sourceSquare >= a2 && sourceSquare <= h2) {
-									addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::q, 0, 0, 0, 0));
-									addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::r, 0, 0, 0, 0));
-									addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::b, 0, 0, 0, 0));
-									addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::n, 0, 0, 0, 0));
-								} else {
-									addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 0, 0, 0, 0));
-									if ((sourceSquare >= a7 && sourceSquare <= h7) && !getBit(Bitboards::occupancies[both], (target + 8))) {
-										addMove(moveList, encodeMove(sourceSquare, (target + 8), piece, 0, 0, 1, 0, 0));
-									}
-								}
-							}
-						}
-						U64 pawnLookup = Bitboards::pawnAttacks[pos.sideToMove][sourceSquare];
-						attacks = pawnLookup & Bitboards::occupancies[Colors::white];
-						while (attacks) {
-							target = Bitboards::getLs1bIndex(attacks);
-							if (sourceSquare >= a2 && sourceSquare <= h2) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::q, 1, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::r, 1, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::b, 1, 0, 0, 0));
-								addMove(moveList, encodeMove(sourceSquare, target, piece, Piece::n, 1, 0, 0, 0));
-							} else {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-							popBit(attacks, target);
-						}
-						if (pos.enPassant != no_sq) {
-							U64 enPassantAttacks = Bitboards::pawnAttacks[pos.sideToMove][sourceSquare] & (1ULL << pos.enPassant);
-							if (enPassantAttacks) {
-								int targetEnPassant = Bitboards::getLs1bIndex(enPassantAttacks);
-								addMove(moveList, encodeMove(sourceSquare, targetEnPassant, piece, 0, 1, 0, 1, 0));
-							}
-						}
-						popBit(bb, sourceSquare);
-					}
-				}
-				if (!captures) {
-					if (piece == Piece::k) {
-						if (pos.castle & CastlingRights::BK) {
-							if (!getBit(Bitboards::occupancies[Colors::both], f8) && !getBit(Bitboards::occupancies[Colors::both], g8)) {
-								if (!pos.isSquareAttacked(e8, Colors::white) && !pos.isSquareAttacked(f8, Colors::white)) {
-									addMove(moveList, encodeMove(e8, g8, piece, 0, 0, 0, 0, 1));
-								}
-							}
-						}
-						if (pos.castle & CastlingRights::BQ) {
-							if (!getBit(Bitboards::occupancies[Colors::both], d8) && !getBit(Bitboards::occupancies[Colors::both], c8) && !getBit(Bitboards::occupancies[Colors::both], b8)) {
-								if (!pos.isSquareAttacked(e8, Colors::white) && !pos.isSquareAttacked(d8, Colors::white)) {
-									addMove(moveList, encodeMove(e8, c8, piece, 0, 0, 0, 0, 1));
-								}
-							}
-						}
-					}
-				}
+	// what the side to move may do without leaving its king in check, worked out once per generateMoves call
+	struct MoveFilter {
+		int kingSquare;
+		U64 checkers;
+		U64 pinned;
+		U64 checkMask; // targets that deal with the check: every square, the checking line or nothing in double check
+
+		// quietChecks only
+		U64 checkSquares[6]; // by piece type, the squares a piece of ours gives check from
+		U64 discoverers; // our pieces that are the only blocker between one of our sliders and their king
+	};
+
+	static MoveFilter computeFilter(Position& pos) {
+		MoveFilter filter;
+		int us = pos.sideToMove, them = us ^ 1;
+		U64 occ = pos.occupancies[Colors::both];
+
+		filter.kingSquare = Bitboards::getLs1bIndex(pos.bitboards[(us == Colors::white) ? Piece::K : Piece::k]);
+		filter.checkers = pos.attackersTo(filter.kingSquare, occ) & pos.occupancies[them];
+		filter.pinned = 0ULL;
+
+		U64 theirQueens = pos.bitboards[(them == Colors::white) ? Piece::Q : Piece::q];
+		U64 snipers = (Magic::getRookAttacks(filter.kingSquare, 0ULL) & (pos.bitboards[(them == Colors::white) ? Piece::R : Piece::r] | theirQueens))
+			| (Magic::getBishopAttacks(filter.kingSquare, 0ULL) & (pos.bitboards[(them == Colors::white) ? Piece::B : Piece::b] | theirQueens));
+
+		while (snipers) {
+			int sniper = Bitboards::getLs1bIndex(snipers);
+			U64 blockers = Bitboards::betweenSquares[filter.kingSquare][sniper] & occ;
+
+			// exactly one piece in between and it is ours
+			if (blockers && !(blockers & (blockers - 1)) && (blockers & pos.occupancies[us])) filter.pinned |= blockers;
+
+			snipers &= snipers - 1;
+		}
+
+		if (!filter.checkers) {
+			filter.checkMask = ~0ULL;
+		} else if (!(filter.checkers & (filter.checkers - 1))) {
+			filter.checkMask = filter.checkers | Bitboards::betweenSquares[filter.kingSquare][Bitboards::getLs1bIndex(filter.checkers)];
+		} else {
+			filter.checkMask = 0ULL;
+		}
+
+		return filter;
+	}
+
+	// fills in the squares that give check to the enemy king, directly or by moving a discoverer off its line
+	static void computeCheckSquares(Position& pos, MoveFilter& filter) {
+		int us = pos.sideToMove, them = us ^ 1;
+		int offset = (us == Colors::white) ? 0 : Piece::p - Piece::P;
+		int theirKing = Bitboards::getLs1bIndex(pos.bitboards[(them == Colors::white) ? Piece::K : Piece::k]);
+		U64 occ = pos.occupancies[Colors::both];
+
+		filter.checkSquares[Piece::P] = Bitboards::pawnAttacks[them][theirKing];
+		filter.checkSquares[Piece::N] = Bitboards::knightAttacks[theirKing];
+		filter.checkSquares[Piece::B] = Magic::getBishopAttacks(theirKing, occ);
+		filter.checkSquares[Piece::R] = Magic::getRookAttacks(theirKing, occ);
+		filter.checkSquares[Piece::Q] = filter.checkSquares[Piece::B] | filter.checkSquares[Piece::R];
+		filter.checkSquares[Piece::K] = 0ULL;
+		filter.discoverers = 0ULL;
+
+		U64 ourQueens = pos.bitboards[Piece::Q + offset];
+		U64 snipers = (Magic::getRookAttacks(theirKing, 0ULL) & (pos.bitboards[Piece::R + offset] | ourQueens))
+			| (Magic::getBishopAttacks(theirKing, 0ULL) & (pos.bitboards[Piece::B + offset] | ourQueens));
+
+		while (snipers) {
+			int sniper = Bitboards::getLs1bIndex(snipers);
+			U64 blockers = Bitboards::betweenSquares[theirKing][sniper] & occ;
+
+			if (blockers && !(blockers & (blockers - 1)) && (blockers & pos.occupancies[us])) filter.discoverers |= blockers;
+
+			snipers &= snipers - 1;
+		}
+	}
+
+	// quiet targets of the piece on sourceSquare that check: the direct check squares, or anywhere off the line for a discoverer
+	static inline U64 checkTargets(const MoveFilter& filter, int pieceType, int sourceSquare, int theirKing) {
+		U64 targets = filter.checkSquares[pieceType];
+
+		if (getBit(filter.discoverers, sourceSquare)) targets |= ~Bitboards::lineThrough[theirKing][sourceSquare];
+
+		return targets;
+	}
+
+	// squares a piece other than the king can move to: it has to answer a check and may not leave its pin line
+	static inline U64 legalTargets(const MoveFilter& filter, int sourceSquare) {
+		if (getBit(filter.pinned, sourceSquare)) return filter.checkMask & Bitboards::lineThrough[filter.kingSquare][sourceSquare];
+
+		return filter.checkMask;
+	}
+
+	// whether the king would be attacked on square once it has left its own square
+	static bool kingSafe(Position& pos, const MoveFilter& filter, int square) {
+		U64 occ = pos.occupancies[Colors::both] & ~(1ULL << filter.kingSquare);
+
+		return !(pos.attackersTo(square, occ) & pos.occupancies[pos.sideToMove ^ 1]);
+	}
+
+	// en passant removes two pawns from their squares, so it is checked on the board it leaves behind
+	static bool enPassantLegal(Position& pos, const MoveFilter& filter, int sourceSquare, int targetSquare) {
+		int captureSquare = targetSquare + ((pos.sideToMove == Colors::white) ? 8 : -8);
+		U64 occ = (pos.occupancies[Colors::both] ^ (1ULL << sourceSquare) ^ (1ULL << captureSquare)) | (1ULL << targetSquare);
+
+		return !(pos.attackersTo(filter.kingSquare, occ) & pos.occupancies[pos.sideToMove ^ 1] & ~(1ULL << captureSquare));
+	}
+
+	using Movegen::MoveList;
+	using Movegen::addMove;
+
+	constexpr U64 rank2Squares = 0x00ff000000000000ULL; // a2-h2
+	constexpr U64 rank3Squares = 0x0000ff0000000000ULL; // a3-h3
+	constexpr U64 rank6Squares = 0x0000000000ff0000ULL; // a6-h6
+	constexpr U64 rank7Squares = 0x000000000000ff00ULL; // a7-h7
+	constexpr U64 fileASquares = 0x0101010101010101ULL; // a8-a1
+
+	// moves every square of bb by offset, towards a8 for negative offsets
+	template<int Offset>
+	static inline U64 shiftBy(U64 bb) {
+		if constexpr (Offset > 0) return bb << Offset;
+		else return bb >> -Offset;
+	}
+
+	// a pinned pawn may only move along the line through its king
+	static inline bool pinAllows(const MoveFilter& filter, int sourceSquare, int targetSquare) {
+		return !getBit(filter.pinned, sourceSquare) || getBit(Bitboards::lineThrough[filter.kingSquare][sourceSquare], targetSquare);
+	}
+
+	// capture is CAPTURE_MOVE or 0
+	template<MoveType Type>
+	static inline void addPromotions(MoveList* moveList, int sourceSquare, int targetSquare, int capture) {
+		addMove(moveList, encodeMove(sourceSquare, targetSquare, QUEEN_PROMOTION | capture));
+
+		// quiescence only looks at the queen
+		if constexpr (Type == MoveType::qsCaptures) return;
+
+		addMove(moveList, encodeMove(sourceSquare, targetSquare, ROOK_PROMOTION | capture));
+		addMove(moveList, encodeMove(sourceSquare, targetSquare, BISHOP_PROMOTION | capture));
+		addMove(moveList, encodeMove(sourceSquare, targetSquare, KNIGHT_PROMOTION | capture));
+	}
+
+	// every pawn in targets got there with the same step, so the source is the target less the offset
+	template<int Offset>
+	static inline void addPawnMoves(MoveList* moveList, U64 targets, const MoveFilter& filter, int flags) {
+		while (targets) {
+			int target = Bitboards::getLs1bIndex(targets);
+			int sourceSquare = target - Offset;
+
+			if (pinAllows(filter, sourceSquare, target)) addMove(moveList, encodeMove(sourceSquare, target, flags));
+
+			targets &= targets - 1;
+		}
+	}
+
+	template<MoveType Type, int Offset>
+	static inline void addPawnPromotions(MoveList* moveList, U64 targets, const MoveFilter& filter, int capture) {
+		while (targets) {
+			int target = Bitboards::getLs1bIndex(targets);
+			int sourceSquare = target - Offset;
+
+			if (pinAllows(filter, sourceSquare, target)) addPromotions<Type>(moveList, sourceSquare, target, capture);
+
+			targets &= targets - 1;
+		}
+	}
+
+	// all pawns at once: each kind of pawn move is one shift of the pawn bitboard
+	template<Colors Us, MoveType Type>
+	static void generatePawnMoves(Position& pos, MoveList* moveList, const MoveFilter& filter) {
+		constexpr Colors Them = (Us == Colors::white) ? Colors::black : Colors::white;
+		constexpr int pawn = (Us == Colors::white) ? Piece::P : Piece::p;
+		constexpr int up = (Us == Colors::white) ? -8 : 8;
+		constexpr int upLeft = (Us == Colors::white) ? -9 : 7; // towards the a file
+		constexpr int upRight = (Us == Colors::white) ? -7 : 9; // towards the h file
+		constexpr U64 doublePushRank = (Us == Colors::white) ? rank3Squares : rank6Squares; // after the first step
+		constexpr U64 promotionSquares = (Us == Colors::white) ? rank7Squares : rank2Squares; // promote on the next step
+
+		U64 empty = ~pos.occupancies[Colors::both];
+		U64 enemies = pos.occupancies[Them];
+		U64 pawns = pos.bitboards[pawn] & ~promotionSquares;
+		U64 promoting = pos.bitboards[pawn] & promotionSquares;
+
+		if constexpr (Type == MoveType::quietChecks) {
+			// a discovering pawn uncovers the check unless it walks up the file of their king
+			int theirKing = Bitboards::getLs1bIndex(pos.bitboards[(Them == Colors::white) ? Piece::K : Piece::k]);
+			U64 discovering = pawns & filter.discoverers & ~(fileASquares << (theirKing & 7));
+			U64 single = shiftBy<up>(pawns) & empty;
+			U64 twice = shiftBy<up>(single & doublePushRank) & empty;
+
+			addPawnMoves<up>(moveList, single & filter.checkMask & (filter.checkSquares[Piece::P] | shiftBy<up>(discovering)), filter, QUIET_MOVE);
+			addPawnMoves<up + up>(moveList, twice & filter.checkMask & (filter.checkSquares[Piece::P] | shiftBy<up + up>(discovering)), filter, DOUBLE_PUSH);
+		} else if constexpr (Type != MoveType::captures && Type != MoveType::qsCaptures) {
+			U64 single = shiftBy<up>(pawns) & empty;
+			U64 twice = shiftBy<up>(single & doublePushRank) & empty;
+
+			addPawnMoves<up>(moveList, single & filter.checkMask, filter, QUIET_MOVE);
+			addPawnMoves<up + up>(moveList, twice & filter.checkMask, filter, DOUBLE_PUSH);
+
+			if (promoting) addPawnPromotions<Type, up>(moveList, shiftBy<up>(promoting) & empty & filter.checkMask, filter, 0);
+		} else if constexpr (Type == MoveType::qsCaptures) {
+			// quiescence has to see a pawn queen on an empty square, addPromotions only adds the queen
+			if (promoting) addPawnPromotions<Type, up>(moveList, shiftBy<up>(promoting) & empty & filter.checkMask, filter, 0);
+		}
+
+		if constexpr (Type != MoveType::quiets && Type != MoveType::quietChecks) {
+			U64 targets = enemies & filter.checkMask;
+
+			addPawnMoves<upLeft>(moveList, shiftBy<upLeft>(pawns & Bitboards::notAFile) & targets, filter, CAPTURE_MOVE);
+			addPawnMoves<upRight>(moveList, shiftBy<upRight>(pawns & Bitboards::notHFile) & targets, filter, CAPTURE_MOVE);
+
+			if (promoting) {
+				addPawnPromotions<Type, upLeft>(moveList, shiftBy<upLeft>(promoting & Bitboards::notAFile) & targets, filter, CAPTURE_MOVE);
+				addPawnPromotions<Type, upRight>(moveList, shiftBy<upRight>(promoting & Bitboards::notHFile) & targets, filter, CAPTURE_MOVE);
 			}
-			if ((pos.sideToMove == Colors::white) ? piece == Piece::N : piece == Piece::n) {
-				while (bb) {
-					sourceSquare = Bitboards::getLs1bIndex(bb);
-					attacks = Bitboards::knightAttacks[sourceSquare] & ((pos.sideToMove == Colors::white) ? ~Bitboards::occupancies[Colors::white] : ~Bitboards::occupancies[Colors::black]);
-					while (attacks) {
-						target = Bitboards::getLs1bIndex(attacks);
-						if (captures) {
-							if (getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						} else {
-							if (!getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 0, 0, 0, 0));
-							} else {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						}
-						popBit(attacks, target);
+
+			if (pos.enPassant != no_sq) {
+				// our pawns that attack the en passant square are the squares a pawn of theirs would attack from it
+				U64 attackers = Bitboards::pawnAttacks[Them][pos.enPassant] & pos.bitboards[pawn];
+
+				while (attackers) {
+					int sourceSquare = Bitboards::getLs1bIndex(attackers);
+
+					if (enPassantLegal(pos, filter, sourceSquare, pos.enPassant)) {
+						addMove(moveList, encodeMove(sourceSquare, pos.enPassant, EN_PASSANT));
 					}
-					popBit(bb, sourceSquare);
+
+					attackers &= attackers - 1;
 				}
 			}
-			if ((pos.sideToMove == Colors::white) ? piece == Piece::B : piece == Piece::b) {
-				while (bb) {
-					sourceSquare = Bitboards::getLs1bIndex(bb);
-					attacks = Magic::getBishopAttacks(sourceSquare, Bitboards::occupancies[Colors::both]) & ((pos.sideToMove == Colors::white) ? ~Bitboards::occupancies[Colors::white] : ~Bitboards::occupancies[Colors::black]);
-					while (attacks) {
-						target = Bitboards::getLs1bIndex(attacks);
-						if (captures) {
-							if (getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						} else {
-							if (!getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 0, 0, 0, 0));
-							} else {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						}
-						popBit(attacks, target);
-					}
-					popBit(bb, sourceSquare);
-				}
+		}
+	}
+
+	template<int PieceType>
+	static inline U64 pieceAttacks(int square, U64 occ) {
+		if constexpr (PieceType == Piece::N) return Bitboards::knightAttacks[square];
+		else if constexpr (PieceType == Piece::B) return Magic::getBishopAttacks(square, occ);
+		else if constexpr (PieceType == Piece::R) return Magic::getRookAttacks(square, occ);
+		else return Magic::getQueenAttacks(square, occ);
+	}
+
+	// the squares a piece of side Us may land on for this kind of generation
+	template<Colors Us, MoveType Type>
+	static inline U64 targetSquares(Position& pos) {
+		constexpr Colors Them = (Us == Colors::white) ? Colors::black : Colors::white;
+
+		if constexpr (Type == MoveType::captures || Type == MoveType::qsCaptures) return pos.occupancies[Them];
+		else if constexpr (Type == MoveType::quiets || Type == MoveType::quietChecks) return ~pos.occupancies[Colors::both];
+		else return ~pos.occupancies[Us];
+	}
+
+	template<Colors Us, MoveType Type, int PieceType>
+	static void generatePieceMoves(Position& pos, MoveList* moveList, const MoveFilter& filter) {
+		constexpr Colors Them = (Us == Colors::white) ? Colors::black : Colors::white;
+		constexpr int piece = (Us == Colors::white) ? PieceType : PieceType + Piece::p - Piece::P;
+
+		U64 bb = pos.bitboards[piece];
+		U64 targets = targetSquares<Us, Type>(pos);
+		int theirKing = 0;
+
+		if constexpr (Type == MoveType::quietChecks) theirKing = Bitboards::getLs1bIndex(pos.bitboards[(Them == Colors::white) ? Piece::K : Piece::k]);
+
+		while (bb) {
+			int sourceSquare = Bitboards::getLs1bIndex(bb);
+			U64 attacks = pieceAttacks<PieceType>(sourceSquare, pos.occupancies[Colors::both]) & targets & legalTargets(filter, sourceSquare);
+
+			if constexpr (Type == MoveType::quietChecks) attacks &= checkTargets(filter, PieceType, sourceSquare, theirKing);
+
+			while (attacks) {
+				int target = Bitboards::getLs1bIndex(attacks);
+
+				addMove(moveList, encodeMove(sourceSquare, target, (getBit(pos.occupancies[Them], target) ? CAPTURE_MOVE : QUIET_MOVE)));
+
+				popBit(attacks, target);
 			}
-			if ((pos.sideToMove == Colors::white) ? piece == Piece::R : piece == Piece::r) {
-				while (bb) {
-					sourceSquare = Bitboards::getLs1bIndex(bb);
-					attacks = Magic::getRookAttacks(sourceSquare, Bitboards::occupancies[Colors::both]) & ((pos.sideToMove == Colors::white) ? ~Bitboards::occupancies[Colors::white] : ~Bitboards::occupancies[Colors::black]);
-					while (attacks) {
-						target = Bitboards::getLs1bIndex(attacks);
-						if (captures) {
-							if (getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						} else {
-							if (!getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 0, 0, 0, 0));
-							} else {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						}
-						popBit(attacks, target);
+
+			popBit(bb, sourceSquare);
+		}
+	}
+
+	template<Colors Us, MoveType Type>
+	static void generateKingMoves(Position& pos, MoveList* moveList, const MoveFilter& filter) {
+		constexpr Colors Them = (Us == Colors::white) ? Colors::black : Colors::white;
+
+		if constexpr (Type == MoveType::allMoves || Type == MoveType::quiets) {
+			constexpr int kingSide = (Us == Colors::white) ? CastlingRights::WK : CastlingRights::BK;
+			constexpr int queenSide = (Us == Colors::white) ? CastlingRights::WQ : CastlingRights::BQ;
+			constexpr int kingFrom = (Us == Colors::white) ? e1 : e8;
+			constexpr int shortPass = (Us == Colors::white) ? f1 : f8, shortTo = (Us == Colors::white) ? g1 : g8;
+			constexpr int longPass = (Us == Colors::white) ? d1 : d8, longTo = (Us == Colors::white) ? c1 : c8, rookPass = (Us == Colors::white) ? b1 : b8;
+
+			U64 occ = pos.occupancies[Colors::both];
+
+			if (!filter.checkers) {
+				if ((pos.castle & kingSide) && !getBit(occ, shortPass) && !getBit(occ, shortTo)) {
+					if (!pos.isSquareAttacked(shortPass, Them) && !pos.isSquareAttacked(shortTo, Them)) {
+						addMove(moveList, encodeMove(kingFrom, shortTo, KING_CASTLE));
 					}
-					popBit(bb, sourceSquare);
 				}
-			}
-			if ((pos.sideToMove == Colors::white) ? piece == Piece::Q : piece == Piece::q) {
-				while (bb) {
-					sourceSquare = Bitboards::getLs1bIndex(bb);
-					attacks = Magic::getQueenAttacks(sourceSquare, Bitboards::occupancies[Colors::both]) & ((pos.sideToMove == Colors::white) ? ~Bitboards::occupancies[Colors::white] : ~Bitboards::occupancies[Colors::black]);
-					while (attacks) {
-						target = Bitboards::getLs1bIndex(attacks);
-						if (captures) {
-							if (getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						} else {
-							if (!getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 0, 0, 0, 0));
-							} else {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						}
-						popBit(attacks, target);
+				if ((pos.castle & queenSide) && !getBit(occ, longPass) && !getBit(occ, longTo) && !getBit(occ, rookPass)) {
+					if (!pos.isSquareAttacked(longPass, Them) && !pos.isSquareAttacked(longTo, Them)) {
+						addMove(moveList, encodeMove(kingFrom, longTo, QUEEN_CASTLE));
 					}
-					popBit(bb, sourceSquare);
 				}
 			}
-			if ((pos.sideToMove == Colors::white) ? piece == Piece::K : piece == Piece::k) {
-				while (bb) {
-					sourceSquare = Bitboards::getLs1bIndex(bb);
-					attacks = Bitboards::kingAttacks[sourceSquare] & ((pos.sideToMove == Colors::white) ? ~Bitboards::occupancies[Colors::white] : ~Bitboards::occupancies[Colors::black]);
-					while (attacks) {
-						target = Bitboards::getLs1bIndex(attacks);
-						if (captures) {
-							if (getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						} else {
-							if (!getBit(((pos.sideToMove == Colors::white) ? Bitboards::occupancies[Colors::black] : Bitboards::occupancies[Colors::white]), target)) {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 0, 0, 0, 0));
-							} else {
-								addMove(moveList, encodeMove(sourceSquare, target, piece, 0, 1, 0, 0, 0));
-							}
-						}
-						popBit(attacks, target);
-					}
-					popBit(bb, sourceSquare);
-				}
+		}
+
+		U64 attacks = Bitboards::kingAttacks[filter.kingSquare] & targetSquares<Us, Type>(pos);
+
+		// the king only gives check by uncovering one of our sliders
+		if constexpr (Type == MoveType::quietChecks) {
+			int theirKing = Bitboards::getLs1bIndex(pos.bitboards[(Them == Colors::white) ? Piece::K : Piece::k]);
+
+			attacks &= checkTargets(filter, Piece::K, filter.kingSquare, theirKing);
+		}
+
+		while (attacks) {
+			int target = Bitboards::getLs1bIndex(attacks);
+
+			if (kingSafe(pos, filter, target)) {
+				addMove(moveList, encodeMove(filter.kingSquare, target, (getBit(pos.occupancies[Them], target) ? CAPTURE_MOVE : QUIET_MOVE)));
 			}
+
+			popBit(attacks, target);
 		}
 	}
-}
 
+	template<Colors Us, MoveType Type>
+	static void generate(Position& pos, MoveList* moveList) {
+		MoveFilter filter = computeFilter(pos);
+
+		if constexpr (Type == MoveType::quietChecks) computeCheckSquares(pos, filter);
+
+		// in double check only the king can move
+		if (!(filter.checkers & (filter.checkers - 1))) {
+			generatePawnMoves<Us, Type>(pos, moveList, filter);
+			generatePieceMoves<Us, Type, Piece::N>(pos, moveList, filter);
+			generatePieceMoves<Us, Type, Piece::B>(pos, moveList, filter);
+			generatePieceMoves<Us, Type, Piece::R>(pos, moveList, filter);
+			generatePieceMoves<Us, Type, Piece::Q>(pos, moveList, filter);
+		}
+
+		generateKingMoves<Us, Type>(pos, moveList, filter);
+	}
+
+	void Movegen::generateMoves(Position& pos, MoveList* moveList, int genType) {
+		moveList->count = 0;
+
+		if (pos.sideToMove == Colors::white) {
+			switch (genType) {
+			case MoveType::captures: generate<Colors::white, MoveType::captures>(pos, moveList); break;
+			case MoveType::quiets:   generate<Colors::white, MoveType::quiets>(pos, moveList); break;
+			case MoveType::evasions: generate<Colors::white, MoveType::evasions>(pos, moveList); break;
+			case MoveType::qsCaptures: generate<Colors::white, MoveType::qsCaptures>(pos, moveList); break;
+			case MoveType::quietChecks: generate<Colors::white, MoveType::quietChecks>(pos, moveList); break;
+			default:                 generate<Colors::white, MoveType::allMoves>(pos, moveList); break;
+			}
+		} else {
+			switch (genType) {
+			case MoveType::captures: generate<Colors::black, MoveType::captures>(pos, moveList); break;
+			case MoveType::quiets:   generate<Colors::black, MoveType::quiets>(pos, moveList); break;
+			case MoveType::evasions: generate<Colors::black, MoveType::evasions>(pos, moveList); break;
+			case MoveType::qsCaptures: generate<Colors::black, MoveType::qsCaptures>(pos, moveList); break;
+			case MoveType::quietChecks: generate<Colors::black, MoveType::quietChecks>(pos, moveList); break;
+			default:                 generate<Colors::black, MoveType::allMoves>(pos, moveList); break;
+			}
+		}
+	}
+}
@@ -0,0 +1,245 @@
+#include "movepick.h"
+#include "movegen.h"
+#include "search.h"
+#include "types.h"
+
+namespace Sloth {
+
+	Search::MovePicker::MovePicker(Position& pos, SearchThread& st, Move ttMove, bool inCheck) : pos(pos), st(st), stage(TT_MOVE), inCheck(inCheck), ttMove(ttMove) {
+		// the pv move of the last iteration is only followed while the line still exists on the board
+		if (st.followPV) {
+			pvMove = st.pvTable[0][st.ply];
+			st.followPV = 0;
+		}
+
+		killers[0] = st.killerMoves[0][st.ply];
+		killers[1] = st.killerMoves[1][st.ply];
+	}
+
+	Search::MovePicker::MovePicker(Position& pos, SearchThread& st, QsPicker, bool inCheck, bool quietChecks)
+		: pos(pos), st(st), stage(inCheck ? GEN_EVASIONS : QS_GEN_CAPTURES), inCheck(inCheck), quietChecks(quietChecks), captureType(MoveType::qsCaptures) {}
+
+	void Search::MovePicker::generateCaptures() {
+		Movegen::generateMoves(pos, &captureList, captureType);
+
+		for (int i = 0; i < captureList.count; i++) {
+			Move move = captureList.moves[i];
+
+			// a push to the queen in quiescence ranks like a pawn taking a queen
+			captureList.scores[i] = MVV_LVA[pos.movedPiece(move)][getMoveCapture(move) ? pos.capturedPiece(move) : (int)Piece::Q];
+		}
+	}
+
+	void Search::MovePicker::generateQuiets() {
+		Movegen::generateMoves(pos, &quietList, MoveType::quiets);
+	}
+
+	// the only list in check, captures go first by mvv-lva and the rest by history
+	void Search::MovePicker::generateEvasions() {
+		Movegen::generateMoves(pos, &captureList, MoveType::evasions);
+
+		for (int i = 0; i < captureList.count; i++) {
+			Move move = captureList.moves[i];
+
+			if (getMoveCapture(move)) {
+				captureList.scores[i] = (1 << 28) + MVV_LVA[pos.movedPiece(move)][pos.capturedPiece(move)];
+			} else {
+				captureList.scores[i] = st.historyMoves[pos.movedPiece(move)][getMoveTarget(move)];
+			}
+		}
+	}
+
+	// moves from the tt, the pv and the killer slots are played before anything is generated, so they are
+	// checked against the board instead of being looked up in the move lists
+	bool Search::MovePicker::isPlayable(Move move) {
+		return pos.isPseudoLegal(move) && pos.isLegal(move);
+	}
+
+	// already handed out by one of the single move stages
+	bool Search::MovePicker::isSpecial(Move move) {
+		return move == ttMove || move == pvMove || move == killers[0] || move == killers[1];
+	}
+
+	// selection step: swaps the best of the unpicked moves to the front of the rest
+	Move Search::MovePicker::pickBest(Movegen::MoveList* moveList) {
+		int best = current;
+
+		for (int i = current + 1; i < moveList->count; i++) {
+			if (moveList->scores[i] > moveList->scores[best]) best = i;
+		}
+
+		Move move = moveList->moves[best];
+		int score = moveList->scores[best];
+
+		moveList->moves[best] = moveList->moves[current];
+		moveList->scores[best] = moveList->scores[current];
+		moveList->moves[current] = move;
+		moveList->scores[current] = score;
+
+		current++;
+
+		return move;
+	}
+
+	Move Search::MovePicker::nextMove() {
+		Move move;
+
+		// the child of the pv move follows the pv, the children of every other move of the main search do not
+		if (stage < QS_GEN_CAPTURES) st.followPV = 0;
+
+		switch (stage) {
+		case TT_MOVE:
+			stage++;
+
+			if (ttMove && isPlayable(ttMove)) {
+				st.followPV = (ttMove == pvMove);
+
+				return ttMove;
+			}
+
+			ttMove = 0;
+
+			[[fallthrough]];
+		case PV_MOVE:
+			stage++;
+
+			if (pvMove && pvMove != ttMove && isPlayable(pvMove)) {
+				st.followPV = 1;
+
+				return pvMove;
+			}
+
+			[[fallthrough]];
+		case GEN_CAPTURES:
+			if (inCheck) {
+				stage = GEN_EVASIONS;
+
+				return nextMove();
+			}
+
+			generateCaptures();
+
+			current = 0;
+			stage++;
+
+			[[fallthrough]];
+		case GOOD_CAPTURES:
+			while (current < captureList.count) {
+				move = pickBest(&captureList);
+
+				if (move == ttMove || move == pvMove) continue;
+
+				// losing captures wait until after the quiets, the consumed front of the list holds them
+				if (see(move, pos) < 0) {
+					captureList.moves[badCaptures++] = move;
+
+					continue;
+				}
+
+				return move;
+			}
+
+			stage++;
+
+			[[fallthrough]];
+		case FIRST_KILLER:
+			stage++;
+
+			move = killers[0];
+
+			if (move && move != ttMove && move != pvMove && !getMoveCapture(move) && isPlayable(move)) return move;
+
+			[[fallthrough]];
+		case SECOND_KILLER:
+			stage++;
+
+			move = killers[1];
+
+			if (move && move != ttMove && move != pvMove && !getMoveCapture(move) && isPlayable(move)) return move;
+
+			[[fallthrough]];
+		case GEN_QUIETS:
+			generateQuiets();
+
+			for (int i = 0; i < quietList.count; i++) {
+				quietList.scores[i] = st.historyMoves[pos.movedPiece(quietList.moves[i])][getMoveTarget(quietList.moves[i])];
+			}
+
+			current = 0;
+			stage++;
+
+			[[fallthrough]];
+		case QUIETS:
+			while (current < quietList.count) {
+				move = pickBest(&quietList);
+
+				if (!isSpecial(move)) return move;
+			}
+
+			current = 0;
+			stage++;
+
+			[[fallthrough]];
+		case BAD_CAPTURES:
+			if (current < badCaptures) return captureList.moves[current++];
+
+			stage = PICKER_DONE;
+
+			return 0;
+
+		case GEN_EVASIONS:
+			generateEvasions();
+
+			current = 0;
+			stage++;
+
+			[[fallthrough]];
+		case EVASIONS:
+			while (current < captureList.count) {
+				move = pickBest(&captureList);
+
+				if (move != ttMove && move != pvMove) return move;
+			}
+
+			stage = PICKER_DONE;
+
+			return 0;
+
+		case QS_GEN_CAPTURES:
+			generateCaptures();
+
+			current = 0;
+			stage++;
+
+			[[fallthrough]];
+		case QS_CAPTURES:
+			if (current < captureList.count) return pickBest(&captureList);
+
+			if (!quietChecks) {
+				stage = PICKER_DONE;
+
+				return 0;
+			}
+
+			stage++;
+
+			[[fallthrough]];
+		case QS_GEN_CHECKS:
+			Movegen::generateMoves(pos, &quietList, MoveType::quietChecks);
+
+			current = 0;
+			stage++;
+
+			[[fallthrough]];
+		case QS_CHECKS:
+			if (current < quietList.count) return quietList.moves[current++];
+
+			stage = PICKER_DONE;
+
+			return 0;
+
+		default:
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef MOVEPICK_H_INCLUDED
+#define MOVEPICK_H_INCLUDED
+
+#include "position.h"
+#include "movegen.h"
+#include "search.h"
+
+namespace Sloth {
+    namespace Search {
+        enum PickerStage {
+            // main search
+            TT_MOVE, PV_MOVE, GEN_CAPTURES, GOOD_CAPTURES, FIRST_KILLER, SECOND_KILLER, GEN_QUIETS, QUIETS, BAD_CAPTURES,
+            // in check, after the tt and pv moves
+            GEN_EVASIONS, EVASIONS,
+            // quiescence and probcut
+            QS_GEN_CAPTURES, QS_CAPTURES, QS_GEN_CHECKS, QS_CHECKS,
+            PICKER_DONE
+        };
+
+        struct QsPicker {}; // selects the quiescence and probcut picker, which a Move and a bool could not tell apart
+
+        // hands out the moves of a node one at a time, best first. Captures are generated first and quiets only
+        // once the tt move, pv move, good captures and killers have failed to cut. The scores live in the move
+        // lists and the next move is selected from the unpicked rest, so moves after a cutoff are never sorted.
+        // The tt, pv and killer moves are checked against the board, so a cutoff by one of them generates nothing.
+        // In check only the evasions are generated, captures first
+        class MovePicker {
+        public:
+            MovePicker(Position& pos, SearchThread& st, Move ttMove, bool inCheck); // every move, for negamax
+            MovePicker(Position& pos, SearchThread& st, QsPicker, bool inCheck, bool quietChecks); // for quiescence and probcut: evasions in check,
+                                                                                                   // else captures and queen promotions, then quiet checks if asked
+
+            Move nextMove(); // 0 once every move has been handed out
+
+        private:
+            Position& pos;
+            SearchThread& st;
+
+            int stage;
+            bool inCheck = false;
+            bool quietChecks = false;
+            int captureType = MoveType::captures;
+            Move ttMove = 0, pvMove = 0;
+            Move killers[2] = { 0, 0 };
+
+            Movegen::MoveList captureList;
+            Movegen::MoveList quietList;
+
+            int current = 0; // first unpicked move of the list of the current stage
+            int badCaptures = 0; // losing captures, kept at the front of captureList
+
+            void generateCaptures();
+            void generateQuiets();
+            void generateEvasions();
+
+            bool isPlayable(Move move);
+            bool isSpecial(Move move);
+
+            Move pickBest(Movegen::MoveList* moveList);
+        };
+    }
+}
+
+#endif
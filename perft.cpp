@@ -2,70 +2,297 @@
 #include <string>
 #include <iomanip>
 #include <sstream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <algorithm>
 #include "perft.h"
 #include "position.h"
 #include "movegen.h"
 
 namespace Sloth {
-	long Perft::nodes = 0;
+	unsigned long long Perft::nodes = 0;
+	int Perft::hashMb = 64;
+	bool Perft::bulkCounting = true;
 
-	void Perft::perft(int depth, Position& pos) {
-		if (depth == 0) {
-			nodes++;
-			return;
+	/*
+		Subtree counts of positions already seen. An entry is two words, the second one
+
+		0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 1111 1111   depth
+		1111 1111 1111 1111 1111 1111 1111 1111 1111 1111 1111 1111 1111 1111 0000 0000   nodes
+
+		and the first the hash key xor-ed with it, so an entry torn between two threads fails the key check
+		the same way it does in the search tt. The first slot of a cluster keeps the deepest count, the second
+		one always takes the newest
+	*/
+	struct PerftEntry {
+		std::atomic<U64> key;
+		std::atomic<U64> data;
+	};
+
+	struct PerftCluster {
+		PerftEntry entries[2];
+	};
+
+	static std::vector<PerftCluster> perftTable;
+	static int perftTableMb = 0;
+	static bool hashing = false; // perft only uses the table while this is on, see perftTest
+
+	static bool probePerftTable(U64 key, int depth, U64* count) {
+		PerftCluster& cluster = perftTable[key % perftTable.size()];
+
+		for (PerftEntry& entry : cluster.entries) {
+			U64 data = entry.data.load(std::memory_order_relaxed);
+
+			if ((entry.key.load(std::memory_order_relaxed) ^ data) == key && (int)(data & 0xff) == depth) {
+				*count = data >> 8;
+
+				return true;
+			}
 		}
 
+		return false;
+	}
+
+	static void storePerftTable(U64 key, int depth, U64 count) {
+		PerftCluster& cluster = perftTable[key % perftTable.size()];
+		PerftEntry& entry = ((int)(cluster.entries[0].data.load(std::memory_order_relaxed) & 0xff) <= depth) ? cluster.entries[0] : cluster.entries[1];
+		U64 data = (count << 8) | (U64)depth;
+
+		entry.data.store(data, std::memory_order_relaxed);
+		entry.key.store(key ^ data, std::memory_order_relaxed);
+	}
+
+	unsigned long long Perft::perft(int depth, Position& pos) {
+		if (depth == 0) return 1;
+
+		U64 count = 0;
+
+		// a single level below is cheaper to count again than to look up
+		if (hashing && depth >= 2 && probePerftTable(pos.hashKey, depth, &count)) return count;
+
 		Movegen::MoveList moveList;
-		Movegen::generateMoves(pos, &moveList, false);
+		Movegen::generateMoves(pos, &moveList, MoveType::allMoves);
+
+		// the generator only hands out legal moves, so the last ply does not have to be played out
+		if (depth == 1 && bulkCounting) return moveList.count;
 
 		for (int c = 0; c < moveList.count; c++) {
-			copyBoard(pos);
-			if (pos.makeMove(pos, moveList.moves[c], MoveType::allMoves)) {
-				perft(depth - 1, pos);
-				takeBack(pos);
+			if (pos.makeMove(pos, moveList.moves[c], MoveType::allMoves, false)) {
+				count += perft(depth - 1, pos);
+				pos.unmakeMove();
 			}
 		}
+
+		if (hashing && depth >= 2) storePerftTable(pos.hashKey, depth, count);
+
+		return count;
+	}
+
+	// one piece of work for the perft threads: a root move and one reply to it. Splitting at the replies
+	// rather than the root moves keeps the threads busy when a few root moves hold most of the tree
+	struct PerftItem {
+		int root; // index into the root move list
+		Move reply;
+		unsigned long long nodes;
+	};
+
+	// each thread works on its own copy of the root position and takes the next unclaimed item until none are left
+	static void perftWorker(Position pos, Movegen::MoveList* rootMoves, std::vector<PerftItem>* items, std::atomic<size_t>* next, int depth) {
+		for (size_t i = (*next)++; i < items->size(); i = (*next)++) {
+			PerftItem& item = (*items)[i];
+
+			pos.makeMove(pos, rootMoves->moves[item.root], MoveType::allMoves, false);
+			pos.makeMove(pos, item.reply, MoveType::allMoves, false);
+
+			item.nodes = Perft::perft(depth - 2, pos);
+
+			pos.unmakeMove();
+			pos.unmakeMove();
+		}
+	}
+
+	// thousands grouped with commas, in integers so large counts print exactly
+	std::string formatNumber(unsigned long long number) {
+		if (number < 1000) return std::to_string(number);
+
+		std::string group = std::to_string(number % 1000);
+
+		return formatNumber(number / 1000) + "," + std::string(3 - group.size(), '0') + group;
 	}
 
-	std::string formatNumber(long long number) {
-		if (number >= 1'000'000'000) return std::to_string(number / 1'000'000'000.0) + "B";
-		if (number >= 1'000'000) return std::to_string(number / 1'000'000.0) + "M";
-		if (number >= 1'000) return std::to_string(number / 1'000.0) + "K";
-		return std::to_string(number);
+	// the table follows the Perft Hash option the next time it is used
+	static void resizePerftTable() {
+		if (perftTableMb == Perft::hashMb) return;
+
+		perftTable = std::vector<PerftCluster>(((size_t)Perft::hashMb << 20) / sizeof(PerftCluster));
+		perftTableMb = Perft::hashMb;
 	}
 
-	void Perft::perftTest(int depth, Position& pos) {
-		const char* squareToCoordinates[] = {
-			"a8", "b8", "c8", "d8", "e8", "f8", "g8", "h8",
-			"a7", "b7", "c7", "d7", "e7", "f7", "g7", "h7",
-			"a6", "b6", "c6", "d6", "e6", "f6", "g6", "h6",
-			"a5", "b5", "c5", "d5", "e5", "f5", "g5", "h5",
-			"a4", "b4", "c4", "d4", "e4", "f4", "g4", "h4",
-			"a3", "b3", "c3", "d3", "e3", "f3", "g3", "h3",
-			"a2", "b2", "c2", "d2", "e2", "f2", "g2", "h2",
-			"a1", "b1", "c1", "d1", "e1", "f1", "g1", "h1",
-		};
+	// nodes under every root move, the table is only used when hashed is set
+	static std::vector<unsigned long long> divide(int depth, Position& pos, Movegen::MoveList& moveList, int threads, bool hashed) {
+		std::vector<unsigned long long> rootNodes(moveList.count, depth > 1 ? 0 : 1);
+
+		if (depth < 2) return rootNodes;
+
+		if (hashed) resizePerftTable();
+
+		hashing = hashed && !perftTable.empty();
+
+		std::vector<PerftItem> items;
+
+		for (int c = 0; c < moveList.count; c++) {
+			Movegen::MoveList replies;
+
+			pos.makeMove(pos, moveList.moves[c], MoveType::allMoves, false);
+			Movegen::generateMoves(pos, &replies, MoveType::allMoves);
+			pos.unmakeMove();
+
+			for (int r = 0; r < replies.count; r++) items.push_back({ c, replies.moves[r], 0 });
+		}
+
+		std::atomic<size_t> next(0);
+		std::vector<std::thread> workers;
+
+		for (int id = 1; id < threads; id++) {
+			workers.emplace_back(perftWorker, pos, &moveList, &items, &next, depth);
+		}
+
+		perftWorker(pos, &moveList, &items, &next, depth);
 
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+
+		hashing = false;
+
+		for (const PerftItem& item : items) rootNodes[item.root] += item.nodes;
+
+		return rootNodes;
+	}
+
+	void Perft::perftTest(int depth, Position& pos, int threads, bool verify) {
 		nodes = 0;
 		printf("\nPerft\n");
 
 		Movegen::MoveList moveList;
-		Movegen::generateMoves(pos, &moveList, false);
+		Movegen::generateMoves(pos, &moveList, MoveType::allMoves);
 
 		long start = getTimeMs();
 
+		std::vector<unsigned long long> rootNodes = divide(depth, pos, moveList, threads, hashMb > 0);
+
 		for (int c = 0; c < moveList.count; c++) {
-			copyBoard(pos);
-			if (pos.makeMove(pos, moveList.moves[c], MoveType::allMoves)) {
-				long cumulativeNodes = nodes;
-				perft(depth - 1, pos);
-				printf("Move: %s%s%c Nodes: %ld\n", squareToCoordinates[getMoveSource(moveList.moves[c])], squareToCoordinates[getMoveTarget(moveList.moves[c])], Movegen::promotedPieces[static_cast<Piece::Pieces>(getMovePromotion(moveList.moves[c]))], nodes - cumulativeNodes);
-				takeBack(pos);
-			}
+			printf("Move: %s Nodes: %llu\n", Movegen::moveToString(moveList.moves[c]).c_str(), rootNodes[c]);
+			nodes += rootNodes[c];
 		}
 
 		long time = getTimeMs() - start;
-		printf("\nDepth: %d\nNodes: %ld\nNodes per second: %s\nTime: %ld ms\n", depth, nodes, formatNumber(static_cast<long long>(nodes / (time / 1000.0))).c_str(), time);
+		printf("\nDepth: %d\nNodes: %llu\nNodes per second: %s\nTime: %ld ms\n", depth, nodes, formatNumber(nodes * 1000 / std::max(time, 1L)).c_str(), time);
+		printf("Bulk counting: %s, hash: %d MB\n", bulkCounting ? "on" : "off", hashMb);
+
+		// the same tree again without the table, every root move has to come out the same
+		if (verify) {
+			std::vector<unsigned long long> plainNodes = divide(depth, pos, moveList, threads, false);
+			int mismatches = 0;
+
+			for (int c = 0; c < moveList.count; c++) {
+				if (plainNodes[c] == rootNodes[c]) continue;
+
+				printf("Move: %s Nodes: %llu, %llu without the hash table\n", Movegen::moveToString(moveList.moves[c]).c_str(), rootNodes[c], plainNodes[c]);
+				mismatches++;
+			}
+
+			printf("Verify: %s\n", mismatches ? "failed" : "ok");
+		}
 	}
-}
 
+	static void clearPerftTable() {
+		for (PerftCluster& cluster : perftTable) {
+			for (PerftEntry& entry : cluster.entries) {
+				entry.key.store(0, std::memory_order_relaxed);
+				entry.data.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Mnps with one decimal, in integers
+	static std::string formatMnps(unsigned long long nodes, long time) {
+		unsigned long long knps = nodes / std::max(time, 1L);
+
+		return std::to_string(knps / 1000) + "." + std::to_string(knps % 1000 / 100);
+	}
+
+	void Perft::perftSuite(const char* path, int maxDepth, int threads) {
+		std::ifstream file(path);
+
+		if (!file) {
+			printf("info string Could not open %s\n", path);
+			return;
+		}
+
+		// every run starts from an empty table, counts cached by an earlier run would make the times meaningless
+		resizePerftTable();
+		clearPerftTable();
+
+		printf("\n   #  depth          nodes   time ms     Mnps  result\n\n");
+
+		Position pos;
+		std::string line;
+		int positions = 0, failures = 0;
+		unsigned long long totalNodes = 0;
+		long totalTime = 0;
+
+		while (std::getline(file, line)) {
+			size_t fenEnd = line.find(';');
+
+			if (fenEnd == std::string::npos) continue;
+
+			// the deepest ";Dn count" within maxDepth is the one that gets run
+			int depth = 0;
+			unsigned long long expected = 0;
+			std::istringstream fields(line.substr(fenEnd));
+			std::string field;
+
+			while (std::getline(fields, field, ';')) {
+				std::istringstream entry(field);
+				char letter = 0;
+				int d = 0;
+				unsigned long long count = 0;
+
+				if ((entry >> letter >> d >> count) && letter == 'D' && d > depth && (maxDepth <= 0 || d <= maxDepth)) {
+					depth = d;
+					expected = count;
+				}
+			}
+
+			if (!depth) continue;
+
+			pos.parseFen(line.substr(0, fenEnd).c_str());
+			positions++;
+
+			Movegen::MoveList moveList;
+			Movegen::generateMoves(pos, &moveList, MoveType::allMoves);
+
+			long start = getTimeMs();
+			unsigned long long count = 0;
+
+			for (unsigned long long rootNodes : divide(depth, pos, moveList, threads, hashMb > 0)) count += rootNodes;
+
+			long time = getTimeMs() - start;
+			bool ok = count == expected;
+
+			totalNodes += count;
+			totalTime += time;
+			if (!ok) failures++;
+
+			printf("%4d  %5d  %13llu  %8ld  %7s  %s", positions, depth, count, time, formatMnps(count, time).c_str(), ok ? "ok" : "FAILED");
+			if (!ok) printf(", expected %llu: %s", expected, line.substr(0, fenEnd).c_str());
+			printf("\n");
+		}
+
+		printf("\ntotal  %5s  %13llu  %8ld  %7s  %d of %d positions failed\n", "", totalNodes, totalTime, formatMnps(totalNodes, totalTime).c_str(), failures, positions);
+		printf("Bulk counting: %s, hash: %d MB, threads: %d\n", bulkCounting ? "on" : "off", hashMb, threads);
+	}
+}
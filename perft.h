@@ -20,11 +20,21 @@ namespace Sloth {
 			return getTickCount();
 		}
 
-		extern long nodes;
+		extern unsigned long long nodes; // total of the last perftTest
 
-		extern  void perft(int depth, Position& pos);
+		extern int hashMb; // size of the table of subtree counts, 0 counts every tree out
+		extern bool bulkCounting; // the last ply is the size of the move list instead of every move made and taken back.
+		                          // Off, perft times make and unmake as well as the generator
 
-		void perftTest(int depth, Position& pos);
+		extern unsigned long long perft(int depth, Position& pos); // leaf nodes below pos
+
+		// divide: the nodes under every root move, the tree is split over threads at the second ply.
+		// verify counts the tree a second time without the hash table and compares the two
+		void perftTest(int depth, Position& pos, int threads = 1, bool verify = false);
+
+		// runs every position of an epd file with lines like "fen ;D1 20 ;D2 400", at its deepest count up to maxDepth
+		// (all depths for 0), and prints nodes, time and Mnps per position with the ones that do not match flagged
+		void perftSuite(const char* path, int maxDepth, int threads = 1);
 	}
 }
 
@@ -14,44 +14,55 @@ using namespace Sloth::Bitboards;
 
 namespace Sloth {
 
-	// TRANSPOSITION ERROR FIXED!!! ~250 elo
-	U64 Zobrist::pieceKeys[12][64];
-	U64 Zobrist::enPassantKeys[64];
-	U64 Zobrist::castlingKeys[16];
-	U64 Zobrist::sideKey;
+	// splitmix64. The xorshift of the magic search is linear with a 32 bit state, so all of its 64 bit numbers lie
+	// in a 32 dimensional space and some sets of keys xor to zero: different positions got the same hash key
+	static constexpr U64 nextKey(U64& state) {
+		U64 z = (state += 0x9E3779B97F4A7C15ULL);
+
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+		return z ^ (z >> 31);
+	}
 
-	void Zobrist::initRandomKeys() {
+	// the keys are one random sequence from the fixed seed: piece keys, then en passant, castling and side to move.
+	// count keys starting after the first skip of them
+	template<int Count>
+	static constexpr std::array<U64, Count> randomKeys(int skip) {
+		U64 state = Magic::RANDOM_SEED;
+		std::array<U64, Count> keys{};
+
+		for (int i = 0; i < skip; i++) nextKey(state);
+
+		for (int i = 0; i < Count; i++) keys[i] = nextKey(state);
+
+		return keys;
+	}
 
-		Magic::randomState = 1804289383;
+	// TRANSPOSITION ERROR FIXED!!! ~250 elo
+	constexpr std::array<std::array<U64, 64>, 12> Zobrist::pieceKeys = [] {
+		std::array<U64, 12 * 64> keys = randomKeys<12 * 64>(0);
+		std::array<std::array<U64, 64>, 12> table{};
 
 		for (int piece = Piece::P; piece <= Piece::k; piece++) {
 			for (int sq = 0; sq < 64; sq++) {
-				Zobrist::pieceKeys[piece][sq] = Magic::getRandomU64Num();
+				table[piece][sq] = keys[piece * 64 + sq];
 			}
 		}
 
-		for (int sq = 0; sq < 64; sq++) {
-			Zobrist::enPassantKeys[sq] = Magic::getRandomU64Num();
-		}
-		//for (int rank : {3, 6}) {
-			//for (int file = 0; file < 8; ++file) {
-				//Zobrist::enPassantKeys[rank * 8 + file] = Magic::getRandomU64Num();
-			//}
-		//}
-
-		for (int i = 0; i < 16; i++) {
-			Zobrist::castlingKeys[i] = Magic::getRandomU64Num();
-		}
+		return table;
+	}();
 
-		Zobrist::sideKey = Magic::getRandomU64Num();
-	}
+	constexpr std::array<U64, 64> Zobrist::enPassantKeys = randomKeys<64>(12 * 64);
+	constexpr std::array<U64, 16> Zobrist::castlingKeys = randomKeys<16>(12 * 64 + 64);
+	constexpr U64 Zobrist::sideKey = randomKeys<1>(12 * 64 + 64 + 16)[0];
 
 	U64 Zobrist::generateHashKey(Position& pos) { // generate unique hash key
 		U64 finalKey = 0ULL;
 		U64 bb;
 
 		for (int piece = Piece::P; piece <= Piece::k; piece++) {
-			bb = Bitboards::bitboards[piece];
+			bb = pos.bitboards[piece];
 
 			while (bb) {
 				int sq = Bitboards::getLs1bIndex(bb);
@@ -73,26 +84,73 @@ namespace Sloth {
 		return finalKey;
 	}
 
-	int Position::makeMove(Position& pos, int move, int moveFlag) {
+	int Position::makeMove(Position& pos, Move move, int moveFlag, bool prefetch) {
 		// quiet
 		if (moveFlag == MoveType::allMoves) {
-			copyBoard(pos);
+			UndoInfo& undo = pos.undoStack[pos.undoIndex++];
+
+			undo.move = move;
+			undo.captured = Piece::emptyPiece;
+			undo.castle = pos.castle;
+			undo.enPassant = pos.enPassant;
+			undo.fifty = pos.fifty;
+			undo.hashKey = pos.hashKey;
+
+#ifdef COPY_MAKE
+			memcpy(undo.bitboards, pos.bitboards, sizeof(pos.bitboards));
+			memcpy(undo.occupancies, pos.occupancies, sizeof(pos.occupancies));
+			memcpy(undo.pieceOn, pos.pieceOn, sizeof(pos.pieceOn));
+#endif
 
 			int sourceSquare = getMoveSource(move);
 			int targetSquare = getMoveTarget(move);
-			int piece = getMovePiece(move);
-			int promotedPiece = getMovePromotion(move);
+			int piece = pos.pieceOn[sourceSquare];
+			int promotedPiece = getMovePromotion(move) ? getPromotionPiece(move) + ((pos.sideToMove == Colors::white) ? 0 : Piece::p - Piece::P) : 0;
 			int captureFlag = getMoveCapture(move);
 			int doubleFlag = getDoublePush(move);
 			int enPassantFlag = getMoveEnpassant(move);
 			int castlingFlag = getMoveCastling(move);
 
-			popBit(Bitboards::bitboards[piece], sourceSquare); // pop bit from sourcesquare
-			setBit(Bitboards::bitboards[piece], targetSquare); // set bit on targetsquare
+			// en passant takes the pawn behind the target square, a double push leaves the square behind it
+			int behindTarget = targetSquare + ((pos.sideToMove == Colors::white) ? 8 : -8);
+			int captureSquare = enPassantFlag ? behindTarget : targetSquare;
+			int capturedPiece = captureFlag ? pos.pieceOn[captureSquare] : (int)Piece::emptyPiece;
+			int newEnPassant = doubleFlag ? behindTarget : (int)no_sq;
+			int newCastle = pos.castle & CASTLING_RIGHTS_CONSTANTS[sourceSquare] & CASTLING_RIGHTS_CONSTANTS[targetSquare];
+
+			int rook = (pos.sideToMove == Colors::white) ? Piece::R : Piece::r;
+			int rookFrom = 0, rookTo = 0;
+
+			if (castlingFlag) {
+				switch (targetSquare)
+				{
+				case (g1): rookFrom = h1; rookTo = f1; break; // king side
+				case (c1): rookFrom = a1; rookTo = d1; break;
+				case (g8): rookFrom = h8; rookTo = f8; break; // black
+				default:   rookFrom = a8; rookTo = d8; break;
+				}
+			}
 
-			// hash the piece (move the piece in hash)
+			// the child key is worked out before the board is touched, so its tt cluster loads while the board is updated
 			hashKey ^= Zobrist::pieceKeys[piece][sourceSquare];
-			hashKey ^= Zobrist::pieceKeys[piece][targetSquare];
+			hashKey ^= Zobrist::pieceKeys[promotedPiece ? promotedPiece : piece][targetSquare];
+
+			if (captureFlag) hashKey ^= Zobrist::pieceKeys[capturedPiece][captureSquare];
+
+			if (pos.enPassant != no_sq) hashKey ^= Zobrist::enPassantKeys[pos.enPassant];
+			if (newEnPassant != no_sq) hashKey ^= Zobrist::enPassantKeys[newEnPassant];
+
+			if (castlingFlag) hashKey ^= Zobrist::pieceKeys[rook][rookFrom] ^ Zobrist::pieceKeys[rook][rookTo];
+
+			hashKey ^= Zobrist::castlingKeys[pos.castle] ^ Zobrist::castlingKeys[newCastle];
+			hashKey ^= Zobrist::sideKey;
+
+			if (prefetch) Search::prefetchHash(hashKey);
+
+			U64 fromTo = (1ULL << sourceSquare) | (1ULL << targetSquare);
+
+			pos.bitboards[piece] ^= fromTo; // move the piece from the source to the target square
+			pos.occupancies[pos.sideToMove] ^= fromTo;
 
 			pos.fifty++;
 
@@ -101,163 +159,162 @@ namespace Sloth {
 			}
 
 			if (captureFlag) { // if move is capturing something
-				int startPiece, endPiece;
-
-				startPiece = (pos.sideToMove == Colors::white) ? Piece::p : Piece::P;
-				endPiece = (pos.sideToMove == Colors::white) ? Piece::k : Piece::K;
-
 				pos.fifty = 0;
 
-				// loop over bb opposite to current side to move
-				for (int bbPiece = startPiece; bbPiece <= endPiece; bbPiece++) {
-					if (getBit(Bitboards::bitboards[bbPiece], targetSquare)) { // if piece on target square, then remove from corresponding bitboard
-						popBit(Bitboards::bitboards[bbPiece], targetSquare);
+				popBit(pos.bitboards[capturedPiece], captureSquare);
+				popBit(pos.occupancies[pos.sideToMove ^ 1], captureSquare);
 
-						// remove the piece from hash
-						hashKey ^= Zobrist::pieceKeys[bbPiece][targetSquare];
+				pos.pieceOn[captureSquare] = Piece::emptyPiece;
 
-						break;
-					}
-				}
+				undo.captured = capturedPiece;
 			}
 
+			pos.pieceOn[sourceSquare] = Piece::emptyPiece;
+			pos.pieceOn[targetSquare] = piece;
+
 			// pawn promotions
 			if (promotedPiece) {
-				popBit(Bitboards::bitboards[(pos.sideToMove == Colors::white) ? Piece::P : Piece::p], targetSquare);// remove pawn from target square
+				popBit(pos.bitboards[piece], targetSquare);// remove pawn from target square
+				setBit(pos.bitboards[promotedPiece], targetSquare); // set up the promoted piece
+
+				pos.pieceOn[targetSquare] = promotedPiece;
+			}
+
+			pos.enPassant = newEnPassant;
 
-				hashKey ^= Zobrist::pieceKeys[(pos.sideToMove == Colors::white) ? Piece::P : Piece::p][targetSquare]; // remove from hash key
+			if (castlingFlag) {
+				U64 rookFromTo = (1ULL << rookFrom) | (1ULL << rookTo);
 
-				setBit(Bitboards::bitboards[promotedPiece], targetSquare); // set up the promoted piece
+				pos.bitboards[rook] ^= rookFromTo;
+				pos.occupancies[pos.sideToMove] ^= rookFromTo;
 
-				hashKey ^= Zobrist::pieceKeys[promotedPiece][targetSquare]; // adding promoted to hash key
+				pos.pieceOn[rookFrom] = Piece::emptyPiece;
+				pos.pieceOn[rookTo] = rook;
 			}
 
-			if (enPassantFlag) {
-				/////////// CHANGE
-				/*(pos.sideToMove == Colors::white)
-					? popBit(Bitboards::bitboards[Piece::p], targetSquare + 8)
-					: popBit(Bitboards::bitboards[Piece::P], targetSquare - 8);*/
+			pos.castle = newCastle;
 
-				if (pos.sideToMove == Colors::white) {
-					popBit(Bitboards::bitboards[Piece::p], targetSquare + 8);
+			pos.occupancies[Colors::both] = pos.occupancies[Colors::white] | pos.occupancies[Colors::black];
 
-					hashKey ^= Zobrist::pieceKeys[Piece::p][targetSquare + 8]; // remove from hash key
-				}
-				else {
-					popBit(Bitboards::bitboards[Piece::P], targetSquare - 8);
+			pos.sideToMove ^= 1;
 
-					hashKey ^= Zobrist::pieceKeys[Piece::P][targetSquare - 8];
-				}
+			// generateMoves only emits legal moves, so there is no king safety test left to do here
+			return 1;
+		}
+		else {
+			// capture
+			if (getMoveCapture(move)) {
+				return makeMove(pos, move, MoveType::allMoves, prefetch);   // added return - fixes crash/bad performance in GCC & Clang - JA
+				
 			}
+			else
+				return 0; // dont make the move
+		}
+	}
 
-			// hash enpassant (remove enpassant square from hash key)
-			if (pos.enPassant != no_sq) hashKey ^= Zobrist::enPassantKeys[pos.enPassant];
+	// takes back the last move made with makeMove from its undo record
+	void Position::unmakeMove() {
+		UndoInfo& undo = undoStack[--undoIndex];
+
+		sideToMove ^= 1;
+
+		castle = undo.castle;
+		enPassant = undo.enPassant;
+		fifty = undo.fifty;
+		hashKey = undo.hashKey;
+
+#ifdef COPY_MAKE
+		memcpy(bitboards, undo.bitboards, sizeof(bitboards));
+		memcpy(occupancies, undo.occupancies, sizeof(occupancies));
+		memcpy(pieceOn, undo.pieceOn, sizeof(pieceOn));
+#else
+		Move move = undo.move;
+		int sourceSquare = getMoveSource(move);
+		int targetSquare = getMoveTarget(move);
+		int piece = pieceOn[targetSquare];
+		int promotedPiece = 0;
+
+		if (getMovePromotion(move)) {
+			promotedPiece = piece;
+			piece = (sideToMove == Colors::white) ? Piece::P : Piece::p;
+		}
 
-			// reset enpassant square regardless of what is moved
-			pos.enPassant = no_sq;
+		U64 fromTo = (1ULL << sourceSquare) | (1ULL << targetSquare);
 
-			if (doubleFlag) { // take a look at this is perft test fails
+		popBit(bitboards[promotedPiece ? promotedPiece : piece], targetSquare);
+		setBit(bitboards[piece], sourceSquare);
 
-				if (pos.sideToMove == Colors::white) {
-					pos.enPassant = targetSquare + 8;
+		occupancies[sideToMove] ^= fromTo;
 
-					hashKey ^= Zobrist::enPassantKeys[targetSquare + 8];
-				}
-				else {
-					pos.enPassant = targetSquare - 8;
+		pieceOn[sourceSquare] = piece;
+		pieceOn[targetSquare] = Piece::emptyPiece;
 
-					hashKey ^= Zobrist::enPassantKeys[targetSquare - 8];
-				}
-			}
+		if (undo.captured != Piece::emptyPiece) {
+			int captureSquare = targetSquare;
 
-			if (castlingFlag) {
-				switch (targetSquare)
-				{
-				case (g1): // king side
-					popBit(Bitboards::bitboards[Piece::R], h1); // remove rook from h1
-					setBit(Bitboards::bitboards[Piece::R], f1); // set it to f1
-
-					hashKey ^= Zobrist::pieceKeys[Piece::R][h1]; // hashing the rook
-					hashKey ^= Zobrist::pieceKeys[Piece::R][f1];
-					break;
-				case (c1):
-					popBit(Bitboards::bitboards[Piece::R], a1);
-					setBit(Bitboards::bitboards[Piece::R], d1);
-
-					hashKey ^= Zobrist::pieceKeys[Piece::R][a1];
-					hashKey ^= Zobrist::pieceKeys[Piece::R][d1];
-					break;
-				case (g8): // black
-					popBit(Bitboards::bitboards[Piece::r], h8);
-					setBit(Bitboards::bitboards[Piece::r], f8);
-
-					hashKey ^= Zobrist::pieceKeys[Piece::r][h8];
-					hashKey ^= Zobrist::pieceKeys[Piece::r][f8];
-					break;
-				case (c8):
-					popBit(Bitboards::bitboards[Piece::r], a8);
-					setBit(Bitboards::bitboards[Piece::r], d8);
-
-					hashKey ^= Zobrist::pieceKeys[Piece::r][a8];
-					hashKey ^= Zobrist::pieceKeys[Piece::r][d8];
-					break;
-				default:
-					break;
-				}
+			if (getMoveEnpassant(move)) captureSquare += (sideToMove == Colors::white) ? 8 : -8;
+
+			setBit(bitboards[undo.captured], captureSquare);
+			setBit(occupancies[sideToMove ^ 1], captureSquare);
+
+			pieceOn[captureSquare] = undo.captured;
+		}
+
+		if (getMoveCastling(move)) {
+			int rook = (sideToMove == Colors::white) ? Piece::R : Piece::r;
+			int rookFrom, rookTo;
+
+			switch (targetSquare)
+			{
+			case (g1): rookFrom = h1; rookTo = f1; break;
+			case (c1): rookFrom = a1; rookTo = d1; break;
+			case (g8): rookFrom = h8; rookTo = f8; break;
+			default:   rookFrom = a8; rookTo = d8; break;
 			}
 
-			// hash castling
-			hashKey ^= Zobrist::castlingKeys[pos.castle];
+			U64 rookFromTo = (1ULL << rookFrom) | (1ULL << rookTo);
 
-			// update castling rights (white a1 rook might be messing it up???)
-			pos.castle &= CASTLING_RIGHTS_CONSTANTS[sourceSquare];
-			pos.castle &= CASTLING_RIGHTS_CONSTANTS[targetSquare];
+			bitboards[rook] ^= rookFromTo;
+			occupancies[sideToMove] ^= rookFromTo;
 
-			hashKey ^= Zobrist::castlingKeys[pos.castle];
+			pieceOn[rookTo] = Piece::emptyPiece;
+			pieceOn[rookFrom] = rook;
+		}
 
-			// update occupancies
-			memset(Bitboards::occupancies, 0ULL, 24);
+		occupancies[Colors::both] = occupancies[Colors::white] | occupancies[Colors::black];
+#endif
+	}
 
-			// DOING THIS FOR NOW, MIGHT BE A QUICKER SOLUTION TO SPEED UP THE MAKEMOVE FUNCTION (like only having one loop or whatever)
-			for (int bPiece = Piece::P; bPiece <= Piece::K; bPiece++) {
-				Bitboards::occupancies[Colors::white] |= Bitboards::bitboards[bPiece];
-			}
+	// passes the turn, the en passant square is gone afterwards
+	void Position::makeNullMove() {
+		UndoInfo& undo = undoStack[undoIndex++];
 
-			for (int bPiece = Piece::p; bPiece <= Piece::k; bPiece++) {
-				Bitboards::occupancies[Colors::black] |= Bitboards::bitboards[bPiece];
-			}
+		undo.move = 0;
+		undo.enPassant = enPassant;
+		undo.hashKey = hashKey;
 
-			Bitboards::occupancies[Colors::both] |= Bitboards::occupancies[Colors::white];
-			Bitboards::occupancies[Colors::both] |= Bitboards::occupancies[Colors::black];
+		if (enPassant != no_sq) hashKey ^= Zobrist::enPassantKeys[enPassant];
 
-			pos.sideToMove ^= 1;
+		enPassant = no_sq;
 
-			hashKey ^= Zobrist::sideKey;
+		sideToMove ^= 1;
 
-			// make sure that king hasnt been exposed into a check
-			// THIS MIGHT TAKE UP MUCH PERFORMANCE
-			if (isSquareAttacked((pos.sideToMove == Colors::white) ? Bitboards::getLs1bIndex(Bitboards::bitboards[Piece::k]) : Bitboards::getLs1bIndex(Bitboards::bitboards[Piece::K]), pos.sideToMove)) {
-				takeBack(pos);
+		hashKey ^= Zobrist::sideKey;
+	}
 
-				return 0;
-			}
-			else
-				return 1;
-		}
-		else {
-			// capture
-			if (getMoveCapture(move)) {
-				return makeMove(pos, move, MoveType::allMoves);   // added return - fixes crash/bad performance in GCC & Clang - JA
-				
-			}
-			else
-				return 0; // dont make the move
-		}
+	void Position::unmakeNullMove() {
+		UndoInfo& undo = undoStack[--undoIndex];
+
+		sideToMove ^= 1;
+
+		enPassant = undo.enPassant;
+		hashKey = undo.hashKey;
 	}
 
 	Position Position::parseFen(const char* fen) { // Will technically load the position
-		memset(Bitboards::bitboards, 0ULL, sizeof(Bitboards::bitboards)); // reset board position and state variables
-		memset(Bitboards::occupancies, 0ULL, sizeof(Bitboards::occupancies));
+		memset(bitboards, 0ULL, sizeof(bitboards)); // reset board position and state variables
+		memset(occupancies, 0ULL, sizeof(occupancies));
+		memset(pieceOn, Piece::emptyPiece, sizeof(pieceOn));
 
 		sideToMove = 0;
 		enPassant = no_sq;
@@ -267,12 +324,10 @@ namespace Sloth {
 
 		fifty = 0;
 
-		Search::repetitionIndex = 0;
-		memset(Search::repetitionTable, 0ULL, sizeof(Search::repetitionTable));
+		repetitionIndex = 0;
+		memset(repetitionTable, 0ULL, sizeof(repetitionTable));
 
-		//printf("\nply: %d\n", Search::ply);
-
-		Search::ply = 0;
+		undoIndex = 0;
 
 		for (int r = 0; r < 8; r++) {
 			for (int f = 0; f < 8; f++) {
@@ -281,7 +336,8 @@ namespace Sloth {
 				if ((*fen >= 'a' && *fen <= 'z') || (*fen >= 'A' && *fen <= 'Z')) {
 					int piece = Piece::charToPiece(*fen);
 
-					setBit(Bitboards::bitboards[piece], sq);
+					setBit(bitboards[piece], sq);
+					pieceOn[sq] = piece;
 
 					fen++;
 				}
@@ -292,7 +348,7 @@ namespace Sloth {
 					int piece = -1;
 
 					for (int bbPiece = Piece::P; bbPiece <= Piece::k; bbPiece++) {
-						if (getBit(Bitboards::bitboards[bbPiece], sq)) {
+						if (getBit(bitboards[bbPiece], sq)) {
 							piece = bbPiece;
 						}
 					}
@@ -348,15 +404,15 @@ namespace Sloth {
 
 		// white pieces bitboards
 		for (int piece = Piece::P; piece <= Piece::K; piece++) {
-			Bitboards::occupancies[white] |= Bitboards::bitboards[piece];
+			occupancies[white] |= bitboards[piece];
 		}
 
 		// black pieces bitboards
 		for (int piece = Piece::p; piece <= Piece::k; piece++) {
-			Bitboards::occupancies[black] |= Bitboards::bitboards[piece];
+			occupancies[black] |= bitboards[piece];
 		}
 
-		Bitboards::occupancies[both] = (Bitboards::occupancies[white] | Bitboards::occupancies[black]);
+		occupancies[both] = (occupancies[white] | occupancies[black]);
 
 		hashKey = Zobrist::generateHashKey(*this);
 
@@ -377,7 +433,7 @@ namespace Sloth {
 				int piece = -1;
 
 				for (int bbPiece = Piece::P; bbPiece <= Piece::k; bbPiece++) {
-					if (getBit(Bitboards::bitboards[bbPiece], sq)) { // if piece on current square
+					if (getBit(bitboards[bbPiece], sq)) { // if piece on current square
 						piece = bbPiece;
 					}
 				}
@@ -414,24 +470,24 @@ namespace Sloth {
 
 	inline int Position::isSquareAttacked(int square, int side) {
 		// attacked by white pawns
-		if ((side == Colors::white) && (Bitboards::pawnAttacks[Colors::black][square] & Bitboards::bitboards[Piece::P]))
+		if ((side == Colors::white) && (Bitboards::pawnAttacks[Colors::black][square] & bitboards[Piece::P]))
 			return 1;
 
-		if ((side == Colors::black) && (Bitboards::pawnAttacks[Colors::white][square] & Bitboards::bitboards[Piece::p]))
+		if ((side == Colors::black) && (Bitboards::pawnAttacks[Colors::white][square] & bitboards[Piece::p]))
 			return 1;
 
-		if (Bitboards::knightAttacks[square] & ((side == Colors::white) ? Bitboards::bitboards[Piece::N] : Bitboards::bitboards[Piece::n]))
+		if (Bitboards::knightAttacks[square] & ((side == Colors::white) ? bitboards[Piece::N] : bitboards[Piece::n]))
 			return 1;
 
-		if (Magic::getBishopAttacks(square, Bitboards::occupancies[Colors::both]) & ((side == Colors::white) ? Bitboards::bitboards[Piece::B] : Bitboards::bitboards[Piece::b])) return 1;
+		if (Magic::getBishopAttacks(square, occupancies[Colors::both]) & ((side == Colors::white) ? bitboards[Piece::B] : bitboards[Piece::b])) return 1;
 
-		if (Magic::getRookAttacks(square, Bitboards::occupancies[Colors::both]) & ((side == Colors::white) ? Bitboards::bitboards[Piece::R] : Bitboards::bitboards[Piece::r]))
+		if (Magic::getRookAttacks(square, occupancies[Colors::both]) & ((side == Colors::white) ? bitboards[Piece::R] : bitboards[Piece::r]))
 			return 1;
 
-		if (Magic::getQueenAttacks(square, Bitboards::occupancies[Colors::both]) & ((side == Colors::white) ? Bitboards::bitboards[Piece::Q] : Bitboards::bitboards[Piece::q]))
+		if (Magic::getQueenAttacks(square, occupancies[Colors::both]) & ((side == Colors::white) ? bitboards[Piece::Q] : bitboards[Piece::q]))
 			return 1;
 
-		if (Bitboards::kingAttacks[square] & ((side == Colors::white) ? Bitboards::bitboards[Piece::K] : Bitboards::bitboards[Piece::k]))
+		if (Bitboards::kingAttacks[square] & ((side == Colors::white) ? bitboards[Piece::K] : bitboards[Piece::k]))
 			return 1;
 
 		return 0;
@@ -446,6 +502,94 @@ namespace Sloth {
 			(Magic::getBishopAttacks(sq, occ) & (bitboards[Piece::B] | bitboards[Piece::b] | bitboards[Piece::Q] | bitboards[Piece::q]));
 	}
 
+	// whether the move could have come out of generateMoves for this board, leaving aside the safety of our king.
+	// Moves from the tt, the pv or the killer slots were made for another position and may be nonsense here
+	bool Position::isPseudoLegal(Move move) {
+		int sourceSquare = getMoveSource(move);
+		int targetSquare = getMoveTarget(move);
+		int flags = getMoveFlags(move);
+		int piece = pieceOn[sourceSquare];
+		int them = sideToMove ^ 1;
+
+		if (piece == Piece::emptyPiece || (piece >= Piece::p) != (sideToMove == Colors::black)) return false;
+
+		if (getBit(occupancies[sideToMove], targetSquare)) return false;
+
+		int type = piece % 6; // Piece::P to Piece::K
+
+		if (flags == EN_PASSANT) return type == Piece::P && targetSquare == enPassant && getBit(Bitboards::pawnAttacks[sideToMove][sourceSquare], targetSquare);
+
+		if (flags == 6 || flags == 7) return false; // unused
+
+		if ((getMoveCapture(move) != 0) != (getBit(occupancies[them], targetSquare) != 0)) return false;
+
+		if (getMoveCastling(move)) {
+			bool kingSide = flags == KING_CASTLE;
+			int right = (sideToMove == Colors::white) ? (kingSide ? WK : WQ) : (kingSide ? BK : BQ);
+			int kingFrom = (sideToMove == Colors::white) ? e1 : e8;
+			int passSquare = kingSide ? kingFrom + 1 : kingFrom - 1;
+			int kingTo = kingSide ? kingFrom + 2 : kingFrom - 2;
+			U64 between = kingSide ? (1ULL << passSquare) | (1ULL << kingTo) : (1ULL << passSquare) | (1ULL << kingTo) | (1ULL << (kingFrom - 3));
+
+			if (type != Piece::K || !(castle & right) || sourceSquare != kingFrom || targetSquare != kingTo) return false;
+
+			if (occupancies[Colors::both] & between) return false;
+
+			return !isSquareAttacked(kingFrom, them) && !isSquareAttacked(passSquare, them) && !isSquareAttacked(kingTo, them);
+		}
+
+		if (type == Piece::P) {
+			int up = (sideToMove == Colors::white) ? -8 : 8;
+			bool lastRank = (sideToMove == Colors::white) ? targetSquare < 8 : targetSquare >= 56;
+
+			if (lastRank != (getMovePromotion(move) != 0)) return false;
+
+			if (getMoveCapture(move)) return getBit(Bitboards::pawnAttacks[sideToMove][sourceSquare], targetSquare);
+
+			if (flags == DOUBLE_PUSH) {
+				bool startRank = (sideToMove == Colors::white) ? (sourceSquare >= a2 && sourceSquare <= h2) : (sourceSquare >= a7 && sourceSquare <= h7);
+
+				return startRank && targetSquare == sourceSquare + 2 * up && !getBit(occupancies[Colors::both], (sourceSquare + up))
+					&& !getBit(occupancies[Colors::both], targetSquare);
+			}
+
+			return targetSquare == sourceSquare + up;
+		}
+
+		if (getMovePromotion(move) || flags == DOUBLE_PUSH) return false;
+
+		U64 attacks;
+
+		switch (type) {
+		case Piece::N: attacks = Bitboards::knightAttacks[sourceSquare]; break;
+		case Piece::B: attacks = Magic::getBishopAttacks(sourceSquare, occupancies[Colors::both]); break;
+		case Piece::R: attacks = Magic::getRookAttacks(sourceSquare, occupancies[Colors::both]); break;
+		case Piece::Q: attacks = Magic::getQueenAttacks(sourceSquare, occupancies[Colors::both]); break;
+		default:       attacks = Bitboards::kingAttacks[sourceSquare]; break;
+		}
+
+		return getBit(attacks, targetSquare);
+	}
+
+	// whether a pseudo legal move keeps our king out of check, castling is fully checked by isPseudoLegal
+	bool Position::isLegal(Move move) {
+		int sourceSquare = getMoveSource(move);
+		int targetSquare = getMoveTarget(move);
+		int them = sideToMove ^ 1;
+		int king = (sideToMove == Colors::white) ? Piece::K : Piece::k;
+
+		if (getMoveCastling(move)) return true;
+
+		U64 captured = 1ULL << targetSquare;
+
+		if (getMoveEnpassant(move)) captured = 1ULL << (targetSquare + ((sideToMove == Colors::white) ? 8 : -8));
+
+		U64 occ = (occupancies[Colors::both] ^ (1ULL << sourceSquare) ^ captured) | (1ULL << targetSquare);
+		int kingSquare = (pieceOn[sourceSquare] == king) ? targetSquare : getLs1bIndex(bitboards[king]);
+
+		return !(attackersTo(kingSquare, occ) & occupancies[them] & ~captured);
+	}
+
 	U64 Position::pawnAttacks(int color) {
 		U64 result = 0;
 
@@ -484,6 +628,13 @@ namespace Sloth {
 			pawns &= pawns - 1;
 		}
 
+#ifdef __AVX2__
+		// every slider at once, one Kogge-Stone fill per direction
+		U64 queens = bitboards[color == Colors::white ? Piece::Q : Piece::q];
+
+		result |= Bitboards::sliderAttacks(bitboards[color == Colors::white ? Piece::R : Piece::r] | queens,
+			bitboards[color == Colors::white ? Piece::B : Piece::b] | queens, occ);
+#else
 		// Calculate rook attacks
 		U64 rooks = bitboards[color == Colors::white ? Piece::R : Piece::r];
 		while (rooks) {
@@ -507,6 +658,7 @@ namespace Sloth {
 			result |= Magic::getQueenAttacks(index, occ);
 			queens &= queens - 1;
 		}
+#endif
 
 		return result;
 	}
@@ -543,6 +695,16 @@ namespace Sloth {
 		// Calculate sliding piece attacks
 		U64 occ = occupancies[both] ^ kingSquare;
 
+#ifdef __AVX2__
+		// every slider at once, one Kogge-Stone fill per direction
+		U64 queens = bitboards[color == Colors::white ? Piece::Q : Piece::q];
+		U64 sliderAttacks;
+		U64 sliderTwice = Bitboards::sliderAttacksTwice(bitboards[color == Colors::white ? Piece::R : Piece::r] | queens,
+			bitboards[color == Colors::white ? Piece::B : Piece::b] | queens, occ, sliderAttacks);
+
+		attackedTwice |= sliderTwice;
+		updateAttacks(sliderAttacks);
+#else
 		// Rook attacks
 		U64 rooks = bitboards[color == Colors::white ? Piece::R : Piece::r];
 		while (rooks) {
@@ -566,6 +728,7 @@ namespace Sloth {
 			updateAttacks(Magic::getQueenAttacks(index, occ));
 			queens &= queens - 1;
 		}
+#endif
 
 		return attackedTwice;
 	}
@@ -7,29 +7,33 @@
 
 #include "bitboards.h"
 #include "time.h"
+#include "piece.h"
 
 #include "types.h"
 
 namespace Sloth {
-	#define copyBoard(pos) \
-		U64 bbsCopy[12], occCopies[3]; \
-		int side, enPassant, castle, fifty; \
-		uint16_t pieceOnSqCopy[64]; \
-		memcpy(bbsCopy, Bitboards::bitboards, 96); \
-		memcpy(occCopies, Bitboards::occupancies, 24); \
-		side = pos.sideToMove, enPassant = pos.enPassant, castle = pos.castle; \
-		fifty = pos.fifty; \
-		U64 hashKeyCopy = pos.hashKey; \
-	
-	#define takeBack(pos) \
-		memcpy(Bitboards::bitboards, bbsCopy, 96); \
-		memcpy(Bitboards::occupancies, occCopies, 24); \
-		pos.sideToMove = side; pos.enPassant = enPassant; pos.castle = castle; \
-		pos.fifty = fifty; \
-		pos.hashKey = hashKeyCopy; \
+	// what makeMove needs to take a move back, one record per move on the board
+	struct UndoInfo {
+		Move move;
+		int captured; // Piece::emptyPiece if the move did not capture
+		int castle;
+		int enPassant;
+		int fifty;
+		U64 hashKey;
+#ifdef COPY_MAKE
+		U64 bitboards[12]; // copy-make: the whole board is restored instead of undoing the move
+		U64 occupancies[3];
+		uint8_t pieceOn[64];
+#endif
+	};
 
 	class Position {
 	public:
+		// 12 bitboards, each piece and each color
+		U64 bitboards[12];
+		U64 occupancies[3]; // This will hold every piece on one bitboard. One for every white piece combined, one for black combined and one with every piece of both color on the bitboard
+		uint8_t pieceOn[64]; // piece on every square, Piece::emptyPiece if there is none
+
 		int sideToMove = -1;
 		int enPassant = no_sq; // en passant square
 		int castle;
@@ -38,7 +42,27 @@ namespace Sloth {
 
 		U64 hashKey = 0ULL;
 
-		int makeMove(Position& pos, int move, int moveFlag);
+		// hash keys of the positions played so far (game moves + current search line)
+		U64 repetitionTable[1000];
+		int repetitionIndex = 0;
+
+		// records of the moves made so far (game moves + current search line)
+		UndoInfo undoStack[1000];
+		int undoIndex = 0;
+
+		int makeMove(Position& pos, Move move, int moveFlag, bool prefetch = true); // prefetch: start loading the child's search tt cluster
+		void unmakeMove();
+
+		// moves only hold squares and a flag, the pieces come from the board before the move is made
+		int movedPiece(Move move) const { return pieceOn[getMoveSource(move)]; }
+		int capturedPiece(Move move) const { // Piece::emptyPiece for a quiet move
+			if (getMoveEnpassant(move)) return (sideToMove == Colors::white) ? Piece::p : Piece::P;
+
+			return pieceOn[getMoveTarget(move)];
+		}
+
+		void makeNullMove();
+		void unmakeNullMove();
 
 		Position parseFen(const char *fen);
 
@@ -46,6 +70,8 @@ namespace Sloth {
 
 		 int isSquareAttacked(int square, int side);
 		U64 attackersTo(int square, U64 occ);
+		bool isPseudoLegal(Move move);
+		bool isLegal(Move move); // for a pseudo legal move
 		U64 pawnAttacks(int color);
 		U64 attackedBy(int color);
 		U64 attackedTwice(int color);
@@ -60,12 +86,11 @@ namespace Sloth {
 
 	namespace Zobrist {
 		//extern U64 pieceKeys[12][4];
-		extern U64 pieceKeys[12][64];
-		extern U64 enPassantKeys[64];
-		extern U64 castlingKeys[16];
-		extern U64 sideKey;
-
-		void initRandomKeys();
+		// built by the compiler, see position.cpp
+		extern const std::array<std::array<U64, 64>, 12> pieceKeys;
+		extern const std::array<U64, 64> enPassantKeys;
+		extern const std::array<U64, 16> castlingKeys;
+		extern const U64 sideKey;
 		U64 generateHashKey(Position& pos);
 	}
 }
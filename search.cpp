@@ -2,12 +2,15 @@
 #include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <thread>
+#include <vector>
 
 #include "search.h"
 #include "evaluate.h"
 #include "movegen.h"
 #include "magic.h"
 #include "uci.h"
+#include "movepick.h"
 
 #undef clamp
 
@@ -15,21 +18,16 @@
 
 namespace Sloth {
 
-	int Search::hashEntries = 0;
-	HASHE* Search::hashTable = NULL;
-	U64 Search::repetitionTable[1000];
-	int Search::repetitionIndex = 0;
+	size_t Search::hashClusters = 0;
+	HASHCLUSTER* Search::hashTable = NULL;
+	uint8_t Search::hashGeneration = 0;
+	U64 Search::hashSalt = 0ULL;
 	const int reductionLimit = 3;
-	int pvLength[MAX_PLY];
-	int pvTable[MAX_PLY][MAX_PLY];
-	int followPV, scorePV;
-	int Search::ply = 0;
 	int Search::contempt = 0;
-	unsigned long long nodes;
-	int killerMoves[2][MAX_PLY];
-	int historyMoves[12][64];
-	int totalEntries = 0;
-	int usedEntries = 0;
+	int Search::threadCount = 1;
+	bool Search::qsearchChecks = false;
+	std::atomic<bool> Search::stopSearch(false);
+	std::atomic<unsigned long long> helperNodes(0);
 	int lastCurrmoveOutput = 0;
 	bool reportedCurrMove = false;
 	const int CURRMOVE_INITIAL_DELAY = 2500;
@@ -37,171 +35,178 @@ namespace Sloth {
 	const int lmpMargins[4] = { 0, 8, 12, 24 };
 	const int pieceValues[13] = { 100, 300, 300, 500, 900, VALUE_INFINITE, 100, 300, 300, 500, 900, VALUE_INFINITE, 0 };
 
+	// every thread zeroes its own slice, which also spreads the first touch of the pages over the threads
 	void Search::clearHashTable() {
-		HASHE* hashEntry;
-		totalEntries = hashEntries;
-		usedEntries = 0;
+		size_t slice = (hashClusters + threadCount - 1) / threadCount;
+		std::vector<std::thread> workers;
 
-		for (hashEntry = hashTable; hashEntry < hashTable + hashEntries; hashEntry++) {
-			hashEntry->hashKey = 0;
-			hashEntry->depth = 0;
-			hashEntry->flag = 0;
-			hashEntry->score = 0;
+		for (int i = 1; i < threadCount && i * slice < hashClusters; i++) {
+			workers.emplace_back([i, slice]() {
+				size_t start = i * slice;
+				size_t count = std::min(slice, hashClusters - start);
+
+				memset((void*)&hashTable[start], 0, count * sizeof(HASHCLUSTER));
+			});
+		}
+
+		memset((void*)hashTable, 0, std::min(slice, hashClusters) * sizeof(HASHCLUSTER));
+
+		for (std::thread& worker : workers) {
+			worker.join();
 		}
+
+		hashGeneration = 0;
+	}
+
+	// O(1) replacement for a clear between games: with a new salt the old entries no longer match any key,
+	// and half a generation cycle of age makes them the first ones to be replaced
+	void Search::newGameHashTable() {
+		hashSalt = Magic::getRandomU64Num();
+		hashGeneration += GENERATION_CYCLE / 2 & GENERATION_MASK;
 	}
 
 	void Search::initHashTable(int mb) {
-		int hashSize = 0x100000 * mb;
-		hashEntries = hashSize / sizeof(HASHE);
+		size_t hashSize = (size_t)mb << 20;
+		hashClusters = hashSize / sizeof(HASHCLUSTER);
 
 		if (hashTable != NULL) {
 			printf("info string Clearing hash memory\n");
-			free(hashTable);
+			my_aligned_free(hashTable);
 		}
 
-		hashTable = (HASHE*)malloc(hashEntries * sizeof(HASHE));
-
-		totalEntries = mb * 1024 * 1024 / sizeof(HASHE);
-		usedEntries = 0;
+		hashTable = (HASHCLUSTER*)my_large_malloc(hashClusters * sizeof(HASHCLUSTER));
 
 		if (hashTable == NULL) {
 			printf("info string Couldnt allocate memory for hash table, trying %dMB\n", mb / 2);
 			initHashTable(mb / 2);
 		} else {
 			clearHashTable();
-			printf("info string Hash table is initialized with %d entries\n", hashEntries);
+			printf("info string Hash table is initialized with %zu entries\n", hashClusters * CLUSTER_SIZE);
 		}
 	}
 
-	static HASHE* readHashEntry(int alpha, int beta, int* bestMove, int depth, Position& pos, bool* hit) {
-		HASHE* hashEntry = &Search::hashTable[pos.hashKey % Search::hashEntries];
-		*hit = false;
-
-		if (hashEntry->hashKey == pos.hashKey) {
-			if (hashEntry->depth >= depth) {
-				int score = hashEntry->score;
-				if (score < -MATE_SCORE) score += Search::ply;
-				if (score > MATE_SCORE) score -= Search::ply;
-				*bestMove = hashEntry->bestMove;
-				*hit = true;
-			} else {
-				*bestMove = hashEntry->bestMove;
-			}
-		}
-
-		return (*hit) ? hashEntry : nullptr;
+	static inline U64 packEntry(Move bestMove, int depth, int genFlag, int score) {
+		return (U64)bestMove | ((U64)depth << 16) | ((U64)genFlag << 24) | ((U64)(uint32_t)score << 32);
 	}
 
-	static void writeHashEntry(int score, int bestMove, int depth, int hashFlag, Position& pos) {
-		HASHE* hashEntry = &Search::hashTable[pos.hashKey % Search::hashEntries];
+	static inline HASHE unpackEntry(U64 data) {
+		HASHE entry;
 
-		if (score < -MATE_SCORE) score -= Search::ply;
-		if (score > MATE_SCORE) score += Search::ply;
+		entry.bestMove = (Move)data;
+		entry.depth = (int)((data >> 16) & 0xff);
+		entry.genFlag = (int)((data >> 24) & 0xff);
+		entry.score = (int)(int32_t)(data >> 32);
 
-		if (hashEntry->depth == 0)
-			usedEntries++;
+		return entry;
+	}
 
-		hashEntry->hashKey = pos.hashKey;
-		hashEntry->score = score;
-		hashEntry->flag = hashFlag;
-		hashEntry->depth = depth;
-		hashEntry->bestMove = bestMove;
+	// all 64 data bits folded into the 16 bit key check
+	static inline uint16_t foldEntry(U64 data) {
+		return (uint16_t)(data ^ (data >> 16) ^ (data >> 32) ^ (data >> 48));
 	}
 
-	double hashFull() {
-		return 1000.0 * usedEntries / totalEntries;
+	// how many searches ago the entry was written, in GENERATION_DELTA units
+	static inline int relativeAge(const HASHE& entry) {
+		return (GENERATION_CYCLE + Search::hashGeneration - entry.genFlag) & GENERATION_MASK;
 	}
 
-	static void enablePVScoring(Movegen::MoveList* movelist) {
-		followPV = 0;
+	static bool readHashEntry(Move* bestMove, int* score, int* flag, int* ttDepth, int depth, int ply, Position& pos) {
+		HASHCLUSTER* cluster = Search::hashCluster(pos.hashKey);
+		uint16_t key = (uint16_t)(pos.hashKey ^ Search::hashSalt);
 
-		for (int i = 0; i < movelist->count; i++) {
-			if (pvTable[0][Search::ply] == movelist->moves[i]) {
-				scorePV = 1;
-				followPV = 1;
-			}
-		}
-	}
+		for (int i = 0; i < CLUSTER_SIZE; i++) {
+			U64 data = cluster->data[i].load(std::memory_order_relaxed);
+
+			if ((cluster->key[i].load(std::memory_order_relaxed) ^ foldEntry(data)) != key) continue;
+
+			HASHE hashEntry = unpackEntry(data);
+
+			if (!hashEntry.depth) continue;
+
+			// a 16 bit key check still lets a few foreign entries through, their moves must not reach the board
+			if (hashEntry.bestMove && pos.isPseudoLegal(hashEntry.bestMove)) *bestMove = hashEntry.bestMove;
+
+			if (hashEntry.depth - 1 < depth) return false;
+
+			*score = hashEntry.score;
+			if (*score < -MATE_SCORE) *score += ply;
+			if (*score > MATE_SCORE) *score -= ply;
 
-	void Search::printMoveScores(Movegen::MoveList* moveList, Position& pos) {
-		for (int i = 0; i < moveList->count; i++) {
-			int move = moveList->moves[i];
-			Movegen::printMove(move);
-			printf("score: %d \n", Search::scoreMove(move, pos));
+			*flag = hashEntry.genFlag & ~GENERATION_MASK;
+			*ttDepth = hashEntry.depth - 1;
+
+			return true;
 		}
+
+		return false;
 	}
 
-	int Search::scoreMove(int move, Position& pos) {
-		int score = 0;
+	static void writeHashEntry(int score, Move bestMove, int depth, int hashFlag, int ply, Position& pos) {
+		HASHCLUSTER* cluster = Search::hashCluster(pos.hashKey);
+		uint16_t key = (uint16_t)(pos.hashKey ^ Search::hashSalt);
 
-		if (scorePV) {
-			if (pvTable[0][Search::ply] == move) {
-				scorePV = 0;
-				return 20000;
-			}
-		}
+		// the depth byte holds depth + 1 and 0 marks an empty slot, so reduced and null move searches that reach
+		// below depth 0 are stored and compared as depth 0 instead of freeing the slot or spilling into the flag byte
+		depth = std::max(depth, 0);
 
-		if (getMoveCapture(move)) {
-			int targetPiece = Piece::P;
-			int startPiece = (pos.sideToMove == Colors::white) ? Piece::p : Piece::P;
-			int endPiece = (pos.sideToMove == Colors::white) ? Piece::k : Piece::K;
-			U64 targetSquare = getMoveTarget(move);
+		int replace = 0;
+		bool sameKey = false;
+		HASHE replaceEntry = unpackEntry(cluster->data[0].load(std::memory_order_relaxed));
 
-			for (int bbPiece = startPiece; bbPiece <= endPiece; bbPiece++) {
-				U64 bb = Bitboards::bitboards[bbPiece];
-				if (getBit(bb, targetSquare)) {
-					targetPiece = bbPiece;
-					break;
-				}
+		for (int i = 0; i < CLUSTER_SIZE; i++) {
+			U64 data = cluster->data[i].load(std::memory_order_relaxed);
+			HASHE entry = unpackEntry(data);
+
+			sameKey = (cluster->key[i].load(std::memory_order_relaxed) ^ foldEntry(data)) == key;
+
+			if (!entry.depth || sameKey) {
+				replace = i;
+				replaceEntry = entry;
+				break;
 			}
 
-			score = MVV_LVA[getMovePiece(move)][targetPiece] + 10000;
-		} else {
-			int killerScore = 0;
-			if (killerMoves[0][Search::ply] == move) {
-				killerScore = 9000;
-			} else if (killerMoves[1][Search::ply] == move) {
-				killerScore = 8000;
+			// the shallowest entry of the oldest search is the one to go
+			if (entry.depth - 2 * relativeAge(entry) < replaceEntry.depth - 2 * relativeAge(replaceEntry)) {
+				replace = i;
+				replaceEntry = entry;
 			}
+		}
 
-			score = (killerScore != 0) ? killerScore : historyMoves[getMovePiece(move)][getMoveTarget(move)];
+		if (sameKey && replaceEntry.depth) {
+			// keep deeper results of the current search unless this one is exact
+			if (hashFlag != hashfEXACT && depth + 1 < replaceEntry.depth - 3 && !relativeAge(replaceEntry))
+				return;
+
+			if (!bestMove) bestMove = replaceEntry.bestMove;
 		}
 
-		return score;
-	}
+		if (score < -MATE_SCORE) score -= ply;
+		if (score > MATE_SCORE) score += ply;
 
-	void Search::sortMoves(Movegen::MoveList* moveList, int bestMove, Position& pos) {
-		int* moveScores = new int[moveList->count];
+		U64 data = packEntry(bestMove, depth + 1, Search::hashGeneration | hashFlag, score);
 
-		for (int i = 0; i < moveList->count; i++) {
-			if (bestMove == moveList->moves[i]) {
-				moveScores[i] = 30000;
-			} else {
-				moveScores[i] = scoreMove(moveList->moves[i], pos);
-			}
-		}
+		cluster->data[replace].store(data, std::memory_order_relaxed);
+		cluster->key[replace].store(key ^ foldEntry(data), std::memory_order_relaxed);
+	}
 
-		for (int i = 1; i < moveList->count; i++) {
-			int currentMove = moveList->moves[i];
-			int currentScore = moveScores[i];
-			int j = i - 1;
+	// permille of the table written by the current search, sampled over the first 1000 clusters
+	static int hashFull() {
+		int used = 0;
 
-			while (j >= 0 && moveScores[j] < currentScore) {
-				moveList->moves[j + 1] = moveList->moves[j];
-				moveScores[j + 1] = moveScores[j];
-				j--;
-			}
+		for (size_t i = 0; i < 1000 && i < Search::hashClusters; i++) {
+			for (int j = 0; j < CLUSTER_SIZE; j++) {
+				HASHE entry = unpackEntry(Search::hashTable[i].data[j].load(std::memory_order_relaxed));
 
-			moveList->moves[j + 1] = currentMove;
-			moveScores[j + 1] = currentScore;
+				if (entry.depth && (entry.genFlag & GENERATION_MASK) == Search::hashGeneration) used++;
+			}
 		}
 
-		delete[] moveScores;
+		return used / CLUSTER_SIZE;
 	}
 
 	static int isRepetition(Position& pos) {
-		for (int i = 0; i < Search::repetitionIndex; i++) {
-			if (Search::repetitionTable[i] == pos.hashKey) {
+		for (int i = 0; i < pos.repetitionIndex; i++) {
+			if (pos.repetitionTable[i] == pos.hashKey) {
 				return 1;
 			}
 		}
@@ -209,11 +214,11 @@ namespace Sloth {
 	}
 
 	static bool isEndgame(Position& pos) {
-		int pawnMaterial = Bitboards::countBits(Bitboards::bitboards[Piece::P] | Bitboards::bitboards[Piece::p]) * 100;
-		int knightMaterial = Bitboards::countBits(Bitboards::bitboards[Piece::N] | Bitboards::bitboards[Piece::n]) * 320;
-		int bishopMaterial = Bitboards::countBits(Bitboards::bitboards[Piece::B] | Bitboards::bitboards[Piece::b]) * 320;
-		int rookMaterial = Bitboards::countBits(Bitboards::bitboards[Piece::R] | Bitboards::bitboards[Piece::r]) * 500;
-		int queenMaterial = Bitboards::countBits(Bitboards::bitboards[Piece::Q] | Bitboards::bitboards[Piece::q]) * 950;
+		int pawnMaterial = Bitboards::countBits(pos.bitboards[Piece::P] | pos.bitboards[Piece::p]) * 100;
+		int knightMaterial = Bitboards::countBits(pos.bitboards[Piece::N] | pos.bitboards[Piece::n]) * 320;
+		int bishopMaterial = Bitboards::countBits(pos.bitboards[Piece::B] | pos.bitboards[Piece::b]) * 320;
+		int rookMaterial = Bitboards::countBits(pos.bitboards[Piece::R] | pos.bitboards[Piece::r]) * 500;
+		int queenMaterial = Bitboards::countBits(pos.bitboards[Piece::Q] | pos.bitboards[Piece::q]) * 950;
 
 		return ((pawnMaterial + knightMaterial + bishopMaterial + rookMaterial + queenMaterial) < 2600);
 	}
@@ -225,11 +230,11 @@ namespace Sloth {
 			return pos.sideToMove == Colors::white ? -Search::contempt : Search::contempt;
 	}
 
-	static U64 considerXrays(int sq, U64 occ) {
+	static U64 considerXrays(int sq, U64 occ, Position& pos) {
 		U64 attackers = 0ULL;
-		U64 attackingBishops = Bitboards::bitboards[Piece::B] | Bitboards::bitboards[Piece::b];
-		U64 attackingRooks = Bitboards::bitboards[Piece::R] | Bitboards::bitboards[Piece::r];
-		U64 attackingQueens = Bitboards::bitboards[Piece::Q] | Bitboards::bitboards[Piece::q];
+		U64 attackingBishops = pos.bitboards[Piece::B] | pos.bitboards[Piece::b];
+		U64 attackingRooks = pos.bitboards[Piece::R] | pos.bitboards[Piece::r];
+		U64 attackingQueens = pos.bitboards[Piece::Q] | pos.bitboards[Piece::q];
 
 		U64 intercardinalRays = Magic::getBishopAttacks(sq, occ);
 		U64 cardinalRays = Magic::getRookAttacks(sq, occ);
@@ -240,7 +245,7 @@ namespace Sloth {
 		return attackers;
 	}
 
-	static U64 minAttacker(U64 attadef, int sideToMove, int& attacker) {
+	static U64 minAttacker(U64 attadef, int sideToMove, int& attacker, Position& pos) {
 		int startPiece = Piece::P;
 		int endPiece = Piece::K;
 
@@ -250,46 +255,32 @@ namespace Sloth {
 		}
 
 		for (attacker = startPiece; attacker <= endPiece; attacker++) {
-			U64 subset = attadef & Bitboards::bitboards[attacker];
+			U64 subset = attadef & pos.bitboards[attacker];
 			if (subset) return (subset & (0 - subset));
 		}
 
 		return 0;
 	}
 
-	static int see(int move, Position& pos) {
+	int Search::see(Move move, Position& pos) {
 		int gain[32];
 		int idepth = 0;
 		int sideToMove = pos.sideToMove ^ 1;
 
 		int fromSq = getMoveSource(move);
 		int toSq = getMoveTarget(move);
-		int attacker = getMovePiece(move);
+		int attacker = pos.movedPiece(move);
 
-		int startPiece = Piece::P;
-		int endPiece = Piece::K;
-		int target = -1;
+		int target = pos.pieceOn[toSq];
 
-		if (sideToMove == Colors::black) {
-			startPiece = Piece::p;
-			endPiece = Piece::k;
-		}
-
-		for (int piece = startPiece; piece <= endPiece; piece++) {
-			if (getBit(Bitboards::bitboards[piece], toSq)) {
-				target = piece;
-				break;
-			}
-		}
-
-		if (target < 0) return 0;
+		if (target == Piece::emptyPiece) return 0;
 
 		U64 seen = 0ULL;
-		U64 occupied = Bitboards::occupancies[Colors::both];
+		U64 occupied = pos.occupancies[Colors::both];
 		U64 attackerBB = 1ULL << fromSq;
 
 		U64 attadef = pos.attackersTo(toSq, occupied);
-		U64 maxXray = occupied & ~(Bitboards::bitboards[Piece::N] | Bitboards::bitboards[Piece::K] | Bitboards::bitboards[Piece::n] | Bitboards::bitboards[Piece::k]);
+		U64 maxXray = occupied & ~(pos.bitboards[Piece::N] | pos.bitboards[Piece::K] | pos.bitboards[Piece::n] | pos.bitboards[Piece::k]);
 
 		gain[idepth] = pieceValues[target];
 
@@ -306,10 +297,10 @@ namespace Sloth {
 			seen |= attackerBB;
 
 			if ((attackerBB & maxXray) != 0) {
-				attadef = considerXrays(toSq, occupied) & ~seen;
+				attadef = considerXrays(toSq, occupied, pos) & ~seen;
 			}
 
-			attackerBB = minAttacker(attadef, sideToMove, attacker);
+			attackerBB = minAttacker(attadef, sideToMove, attacker, pos);
 			sideToMove ^= 1;
 		}
 
@@ -320,67 +311,82 @@ namespace Sloth {
 		return gain[0];
 	}
 
-	static int quiescence(int alpha, int beta, Position& pos) {
-		bool ttHit;
-		int bestMove = 0;
-		HASHE* ttEntry = readHashEntry(alpha, beta, &bestMove, 0, pos, &ttHit);
+	// called every 2048 nodes. The main thread polls the clock and stdin, the helpers
+	// only look at the shared stop flag and publish their node count
+	static void checkUp(Position& pos, Search::SearchThread& st) {
+		if (st.id == 0) {
+			pos.time.communicate();
+
+			if (pos.time.stopped) Search::stopSearch = true;
+		} else {
+			helperNodes += st.nodes - st.flushedNodes;
+			st.flushedNodes = st.nodes;
+
+			if (Search::stopSearch) pos.time.stopped = true;
+		}
+	}
+
+	// qsPly counts the quiescence plies, quiet checks are only tried on the first one
+	static int quiescence(int alpha, int beta, Position& pos, Search::SearchThread& st, int qsPly = 0) {
+		Move bestMove = 0;
 
-		int ttMove = 0;
 		int ttEval = EVAL_UNKNOWN;
 		int ttFlag = NO_HASH_ENTRY;
 		int ttDepth = 0;
 
-		if (ttHit) {
-			ttMove = ttEntry->bestMove;
-			ttEval = ttEntry->score;
-			ttFlag = ttEntry->flag;
-			ttDepth = ttEntry->depth;
-		}
+		readHashEntry(&bestMove, &ttEval, &ttFlag, &ttDepth, 0, st.ply, pos);
 
 		if (ttDepth >= 0 && ttEval != EVAL_UNKNOWN && ((ttFlag == hashfALPHA && ttEval <= alpha) || (ttFlag == hashfBETA && ttEval >= beta) || (ttFlag == hashfEXACT))) {
 			return ttEval;
 		}
 
-		if ((nodes & 2047) == 0) pos.time.communicate();
+		if ((st.nodes & 2047) == 0) checkUp(pos, st);
 
-		nodes++;
+		st.nodes++;
 
-		if (Search::ply > MAX_PLY - 1) return Eval::evaluate(pos);
+		if (st.ply > MAX_PLY - 1) return Eval::evaluate(pos);
 
-		int eval = Eval::evaluate(pos);
+		// only with QSearch Checks on: no standing pat in check, every evasion gets searched instead.
+		// Off, quiescence stands pat and searches the (legal) captures whether in check or not
+		bool inCheck = Search::qsearchChecks && pos.isSquareAttacked(Bitboards::getLs1bIndex(pos.bitboards[(pos.sideToMove == Colors::white) ? Piece::K : Piece::k]), pos.sideToMove ^ 1);
 
-		if (eval >= beta) {
-			return beta;
-		}
+		if (!inCheck) {
+			int eval = Eval::evaluate(pos);
 
-		if (eval > alpha) {
-			alpha = eval;
+			if (eval >= beta) {
+				return beta;
+			}
+
+			if (eval > alpha) {
+				alpha = eval;
+			}
 		}
 
-		Movegen::MoveList moveList[1];
-		Movegen::generateMoves(pos, moveList, true);
-		Search::sortMoves(moveList, 0, pos);
+		Search::MovePicker picker(pos, st, Search::QsPicker(), inCheck, Search::qsearchChecks && qsPly == 0);
+		Move move;
+		int legalMoves = 0;
 
-		for (int c = 0; c < moveList->count; c++) {
-			if (see(moveList->moves[c], pos) < -83) {
+		while ((move = picker.nextMove())) {
+			if (!inCheck && Search::see(move, pos) < -83) {
 				continue;
 			}
 
-			copyBoard(pos);
-			Search::ply++;
-			Search::repetitionIndex++;
-			Search::repetitionTable[Search::repetitionIndex] = pos.hashKey;
+			st.ply++;
+			pos.repetitionIndex++;
+			pos.repetitionTable[pos.repetitionIndex] = pos.hashKey;
 
-			if (pos.makeMove(pos, moveList->moves[c], captures) == 0) {
-				Search::ply--;
-				Search::repetitionIndex--;
+			if (pos.makeMove(pos, move, allMoves) == 0) {
+				st.ply--;
+				pos.repetitionIndex--;
 				continue;
 			}
 
-			int score = -quiescence(-beta, -alpha, pos);
-			Search::ply--;
-			Search::repetitionIndex--;
-			takeBack(pos);
+			legalMoves++;
+
+			int score = -quiescence(-beta, -alpha, pos, st, qsPly + 1);
+			st.ply--;
+			pos.repetitionIndex--;
+			pos.unmakeMove();
 
 			if (pos.time.stopped == true) return 0;
 
@@ -393,10 +399,11 @@ namespace Sloth {
 			}
 		}
 
+		if (inCheck && legalMoves == 0) return -MATE_VALUE + st.ply;
+
 		return alpha;
 	}
 
-	static Search::SearchStack ss[MAX_PLY];
 }
 
 
@@ -409,57 +416,48 @@ namespace Sloth {
 	
 	
 
-	 int Search::negamax(int alpha, int beta, int depth, bool cutnode, Position& pos) {
+	 int Search::negamax(int alpha, int beta, int depth, bool cutnode, Position& pos, SearchThread& st) {
 
-		SearchStack* currentSS = &ss[Search::ply];
+		SearchStack* currentSS = &st.ss[st.ply];
 
-		pvLength[Search::ply] = Search::ply; // inits the PV length
+		st.pvLength[st.ply] = st.ply; // inits the PV length
 
 		int score = 0;
-		int bestMove = 0;
+		Move bestMove = 0;
 
 		int hashFlag = hashfALPHA;
 
 		bool pvNode = beta - alpha > 1;
-		bool isRoot = (Search::ply == 0);
+		bool isRoot = (st.ply == 0);
 
-		if (Search::ply && (isRepetition(pos) || pos.fifty >= 100)) return 0; // draw score, repetition has occured
+		if (st.ply && (isRepetition(pos) || pos.fifty >= 100)) return 0; // draw score, repetition has occured
 
-		bool ttHit;
-
-		HASHE* ttEntry = readHashEntry(alpha, beta, &bestMove, depth, pos, &ttHit);
-
-		int ttMove = 0;
 		int ttEval = EVAL_UNKNOWN;
 		int ttFlag = NO_HASH_ENTRY;
 		int ttDepth = 0;
 
-		if (ttHit) {
-			ttMove = ttEntry->bestMove;
-			ttEval = ttEntry->score;
-			ttFlag = ttEntry->flag;
-			ttDepth = ttEntry->depth;
-		}
+		readHashEntry(&bestMove, &ttEval, &ttFlag, &ttDepth, depth, st.ply, pos);
 
 		if (!pvNode && ttDepth >= depth && ttEval != EVAL_UNKNOWN && ((ttFlag == hashfALPHA && ttEval <= alpha) || (ttFlag == hashfBETA && ttEval >= beta) || (ttFlag == hashfEXACT))) {
 			return ttEval;
 		}
 
-		if ((nodes & 2047) == 0) pos.time.communicate();
+		if ((st.nodes & 2047) == 0) checkUp(pos, st);
 
-		if (isRoot) {
+		// the currmove state belongs to the main thread, the helpers run the same root code
+		if (isRoot && st.id == 0) {
 			lastCurrmoveOutput = pos.time.startTime - CURRMOVE_INTERVAL;
 		}
 
 		// recursion escape condition
-		if (depth == 0) return quiescence(alpha, beta, pos);
+		if (depth == 0) return quiescence(alpha, beta, pos, st);
 
 		// preventing overflow of arrays
-		if (Search::ply > MAX_PLY - 1) return Eval::evaluate(pos);
+		if (st.ply > MAX_PLY - 1) return Eval::evaluate(pos);
 
-		nodes++;
+		st.nodes++;
 
-		int kingCheck = pos.isSquareAttacked((pos.sideToMove == Colors::white) ? Bitboards::getLs1bIndex(Bitboards::bitboards[Piece::K]) : Bitboards::getLs1bIndex(Bitboards::bitboards[Piece::k]), pos.sideToMove ^ 1);
+		int kingCheck = pos.isSquareAttacked((pos.sideToMove == Colors::white) ? Bitboards::getLs1bIndex(pos.bitboards[Piece::K]) : Bitboards::getLs1bIndex(pos.bitboards[Piece::k]), pos.sideToMove ^ 1);
 
 		if (kingCheck) depth++; // If the king is in check, then we increase Search::ply depth by one to prevent immediately getting mated
 
@@ -471,16 +469,16 @@ namespace Sloth {
 
 		bool improving = false;
 
-		if (Search::ply >= 2) {
-			if (Search::ply >= 4 && ss[Search::ply - 2].staticEval == EVAL_UNKNOWN) {
-				improving = currentSS->staticEval > ss[Search::ply - 4].staticEval || ss[Search::ply - 4].staticEval == EVAL_UNKNOWN;
+		if (st.ply >= 2) {
+			if (st.ply >= 4 && st.ss[st.ply - 2].staticEval == EVAL_UNKNOWN) {
+				improving = currentSS->staticEval > st.ss[st.ply - 4].staticEval || st.ss[st.ply - 4].staticEval == EVAL_UNKNOWN;
 			}
 			else {
-				improving = currentSS->staticEval > ss[Search::ply - 2].staticEval || ss[Search::ply - 2].staticEval == EVAL_UNKNOWN;
+				improving = currentSS->staticEval > st.ss[st.ply - 2].staticEval || st.ss[st.ply - 2].staticEval == EVAL_UNKNOWN;
 			}
 		}	
 
-		if (ply && !pvNode && depth < 2 && (staticEval + 339) <= alpha) return quiescence(alpha, beta, pos);
+		if (st.ply && !pvNode && depth < 2 && (staticEval + 339) <= alpha) return quiescence(alpha, beta, pos, st);
 
 		if (depth < 3 && !pvNode && !kingCheck && abs(beta - 1) > -VALUE_INFINITE + 100) {
 			int evalMargin = 120 * depth;
@@ -496,36 +494,29 @@ namespace Sloth {
 		}
 
 		// null move pruning
-		if (depth >= 3 && !kingCheck && Search::ply && !Eval::isEndgame()) {
-			copyBoard(pos);
+		if (depth >= 3 && !kingCheck && st.ply && !Eval::isEndgame(pos)) {
+			st.ply++;
 
-			Search::ply++;
+			pos.repetitionIndex++;
+			pos.repetitionTable[pos.repetitionIndex] = pos.hashKey;
 
-			Search::repetitionIndex++;
-			Search::repetitionTable[Search::repetitionIndex] = pos.hashKey;
+			pos.makeNullMove(); // switching the side gives the opponent an extra move to make
 
-			if (pos.enPassant != no_sq) // hash enpassant if available
-				pos.hashKey ^= Zobrist::enPassantKeys[pos.enPassant];
+			Search::prefetchHash(pos.hashKey);
 
-			pos.enPassant = no_sq;
+			score = -negamax(-beta, -beta + 1, depth - 2 - (depth >= 8 ? 3 : 2), !cutnode, pos, st);
 
-			pos.sideToMove ^= 1; // switching the side gives the opponent an extra move to make
+			st.ply--;
+			pos.repetitionIndex--;
 
-			pos.hashKey ^= Zobrist::sideKey;
-
-			score = -negamax(-beta, -beta + 1, depth - 2 - (depth >= 8 ? 3 : 2), !cutnode, pos);
-
-			Search::ply--;
-			Search::repetitionIndex--;
-
-			takeBack(pos);
+			pos.unmakeNullMove();
 
 			if (pos.time.stopped == true) return 0; // returns 0 if time is up
 
 			// fail hard beta cutoff
 			if (score >= beta) {
 				// store hash entry
-				writeHashEntry(beta, bestMove, depth, hashfBETA, pos);
+				writeHashEntry(beta, bestMove, depth, hashfBETA, st.ply, pos);
 
 				return beta;
 			}
@@ -533,7 +524,7 @@ namespace Sloth {
 
 		bool canFutilityPrune = false;
 
-		if (ply && !pvNode && (depth <= 8)) {
+		if (st.ply && !pvNode && (depth <= 8)) {
 			if ((staticEval + (168 * depth)) <= alpha) canFutilityPrune = true;
 		}
 
@@ -544,7 +535,7 @@ namespace Sloth {
 				int newScore;
 
 				if (depth == 1) {
-					newScore = quiescence(alpha, beta, pos);
+					newScore = quiescence(alpha, beta, pos, st);
 
 					return (newScore > score) ? newScore : score;
 				}
@@ -552,7 +543,7 @@ namespace Sloth {
 				score += 175;
 
 				if (score < beta && depth <= 2) {
-					newScore = quiescence(alpha, beta, pos);
+					newScore = quiescence(alpha, beta, pos, st);
 
 					if (newScore < beta) {
 						return (newScore > score) ? newScore : score;
@@ -564,90 +555,78 @@ namespace Sloth {
 		// ProbCut
 		int probCutBeta = std::min(beta + 227, MATE_VALUE - MAX_PLY - 1);
 
-		if (depth >= 6 && !pvNode && !kingCheck && ply > 0 && !(ttDepth >= depth - 3 && ttEval != EVAL_UNKNOWN && ttEval < probCutBeta)) {
+		if (depth >= 6 && !pvNode && !kingCheck && st.ply > 0 && !(ttDepth >= depth - 3 && ttEval != EVAL_UNKNOWN && ttEval < probCutBeta)) {
 			int probCutBeta = beta + 172;
 			int reducedDepth = depth - 4;
 
-			Movegen::MoveList captureList[1];
-			Movegen::generateMoves(pos, captureList, true);
-
-			sortMoves(captureList, 0, pos);
+			MovePicker picker(pos, st, QsPicker(), false, false); // captures only, the node is not in check
+			Move move;
 
-			for (int c = 0; c < captureList->count; c++) {
+			while ((move = picker.nextMove())) {
 
 				if (pos.time.stopped) return 0;
 
-				if (see(captureList->moves[c], pos) < 0) {
+				if (see(move, pos) < 0) {
 					continue;
 				}
 
-				copyBoard(pos);
+				st.ply++;
 
-				Search::ply++;
+				pos.repetitionIndex++;
+				pos.repetitionTable[pos.repetitionIndex] = pos.hashKey;
 
-				Search::repetitionIndex++;
-				Search::repetitionTable[Search::repetitionIndex] = pos.hashKey;
+				if (pos.makeMove(pos, move, allMoves) == 0) {
+					st.ply--;
 
-				if (pos.makeMove(pos, captureList->moves[c], allMoves) == 0) {
-					Search::ply--;
-
-					Search::repetitionIndex--;
+					pos.repetitionIndex--;
 
 					continue; // skip to next move
 				}
 
-				score = -quiescence(-probCutBeta, -probCutBeta + 1, pos);
+				score = -quiescence(-probCutBeta, -probCutBeta + 1, pos, st);
 
 				if (score >= probCutBeta) {
-					score = -negamax(-probCutBeta, -probCutBeta + 1, reducedDepth, !cutnode, pos);
+					score = -negamax(-probCutBeta, -probCutBeta + 1, reducedDepth, !cutnode, pos, st);
 				}
 
-				Search::ply--;
-				Search::repetitionIndex--;
+				st.ply--;
+				pos.repetitionIndex--;
 
-				takeBack(pos);
+				pos.unmakeMove();
 
 				if (score >= probCutBeta) {
-					writeHashEntry(score, captureList->moves[c], depth - 4, hashfBETA, pos);
+					writeHashEntry(score, move, depth - 4, hashfBETA, st.ply, pos);
 
 					return score;
 				}
 			}
 		}
 
-		Movegen::MoveList moveList[1];
-
-		Movegen::generateMoves(pos, moveList, false);
-
-		if (followPV) {
-			enablePVScoring(moveList);
-		}
-
-		sortMoves(moveList, bestMove, pos); // sort the moves to speed stuff up (doing the same in quiescence search)
+		MovePicker picker(pos, st, bestMove, kingCheck != 0);
 
 		int movesSearched = 0;
+		int moveCount = 0;
+		Move move;
 
-		for (int c = 0; c < moveList->count; c++) {
-			const int move = moveList->moves[c];
-
-			copyBoard(pos);
+		while ((move = picker.nextMove())) {
+			moveCount++;
 
-			Search::ply++;
+			st.ply++;
 
-			Search::repetitionIndex++;
-			Search::repetitionTable[Search::repetitionIndex] = pos.hashKey;
+			pos.repetitionIndex++;
+			pos.repetitionTable[pos.repetitionIndex] = pos.hashKey;
 
-			if (pos.makeMove(pos, moveList->moves[c], allMoves) == 0) { // make sure to only make the legal moves
-				Search::ply--;
+			if (pos.makeMove(pos, move, allMoves) == 0) { // make sure to only make the legal moves
+				st.ply--;
 
-				Search::repetitionIndex--;
+				pos.repetitionIndex--;
 
 				continue; // skip to next move
 			}
 
-			reportedCurrMove = false;
+			if (isRoot && st.id == 0) reportedCurrMove = false;
 
-			if (isRoot && !reportedCurrMove) {
+			if (isRoot && st.id == 0 && !reportedCurrMove) {
 				int now = pos.time.getTimeMs();
 				int elapsed = now - pos.time.startTime;
 				int elapsedSinceLast = now - lastCurrmoveOutput;
@@ -656,7 +635,7 @@ namespace Sloth {
                 printf("info depth %d currmove %s currmovenumber %d\n",
                 depth,
                 Movegen::moveToString(move).c_str(),
-                c + 1);
+                moveCount);
 
 
 					lastCurrmoveOutput = now;
@@ -667,32 +646,32 @@ namespace Sloth {
 			legalMoves++;
 
 			if (movesSearched == 0) {
-				score = -negamax(-beta, -alpha, depth - 1, !cutnode, pos); // doing the normal AB search
+				score = -negamax(-beta, -alpha, depth - 1, !cutnode, pos, st); // doing the normal AB search
 			}
 			else {
 				// futility pruning on current move
 
 				if (canFutilityPrune && (legalMoves > 1)) {
-					if (!pos.isSquareAttacked(Bitboards::getLs1bIndex(Bitboards::bitboards[(pos.sideToMove == Colors::white) ? Piece::K : Piece::k]), pos.sideToMove ^ 1)
-						&& (killerMoves[0][ply] != move)
-						&& (killerMoves[1][ply] != move)
-						&& (getMovePiece(move) != Piece::P && getMovePiece(move) != Piece::p)
+					if (!pos.isSquareAttacked(Bitboards::getLs1bIndex(pos.bitboards[(pos.sideToMove == Colors::white) ? Piece::K : Piece::k]), pos.sideToMove ^ 1)
+						&& (st.killerMoves[0][st.ply] != move)
+						&& (st.killerMoves[1][st.ply] != move)
+						&& (pos.pieceOn[getMoveTarget(move)] != Piece::P && pos.pieceOn[getMoveTarget(move)] != Piece::p) // the move is already on the board
 						&& !getMovePromotion(move)
 						&& !getMoveCastling(move) && !getMoveCapture(move)) {
 
-						repetitionIndex--;
-						ply--;
-						takeBack(pos);
+						pos.repetitionIndex--;
+						st.ply--;
+						pos.unmakeMove();
 
 						continue;
 					}
 				}
 
 				// late move pruning
-				if (ply && !pvNode && depth <= 3 && !kingCheck && !getMoveCapture(move) && (legalMoves > lmpMargins[depth])) {
-					repetitionIndex--;
-					ply--;
-					takeBack(pos);
+				if (st.ply && !pvNode && depth <= 3 && !kingCheck && !getMoveCapture(move) && (legalMoves > lmpMargins[depth])) {
+					pos.repetitionIndex--;
+					st.ply--;
+					pos.unmakeMove();
 
 					continue;
 				}
@@ -703,26 +682,26 @@ namespace Sloth {
 
 					if (pvNode) R--;
 
-					score = -negamax(-alpha - 1, -alpha, depth - 1 - std::max(0, R), true, pos);
+					score = -negamax(-alpha - 1, -alpha, depth - 1 - std::max(0, R), true, pos, st);
 				}
 				else
 					score = alpha + 1;
 
 				// principle variation search
 				if (score > alpha) {
-					score = -negamax(-alpha - 1, -alpha, depth - 1, false, pos); // better move has been found during LMR, re-search at full depth but with narrowed score bandwith
+					score = -negamax(-alpha - 1, -alpha, depth - 1, false, pos, st); // better move has been found during LMR, re-search at full depth but with narrowed score bandwith
 
 					// if fails to prove that other moves are bad
 					if ((score > alpha) && (score < beta)) { // if LMR fails, re-search at full depth and full score bandwith
-						score = -negamax(-beta, -alpha, depth - 1, !cutnode, pos);
+						score = -negamax(-beta, -alpha, depth - 1, !cutnode, pos, st);
 					}
 				}
 			}
 
-			Search::ply--;
-			Search::repetitionIndex--;
+			st.ply--;
+			pos.repetitionIndex--;
 
-			takeBack(pos);
+			pos.unmakeMove();
 
 			if (pos.time.stopped == true) return 0;
 
@@ -735,26 +714,26 @@ namespace Sloth {
 
 				bestMove = move;
 
-				historyMoves[getMovePiece(move)][getMoveTarget(move)] += depth;
+				st.historyMoves[pos.movedPiece(move)][getMoveTarget(move)] += depth;
 
 				alpha = score; //PV node
 
-				pvTable[Search::ply][Search::ply] = move;
+				st.pvTable[st.ply][st.ply] = move;
 
-				for (int next = Search::ply + 1; next < pvLength[Search::ply + 1]; next++) {
-					pvTable[Search::ply][next] = pvTable[Search::ply + 1][next];
+				for (int next = st.ply + 1; next < st.pvLength[st.ply + 1]; next++) {
+					st.pvTable[st.ply][next] = st.pvTable[st.ply + 1][next];
 				}
 
-				pvLength[Search::ply] = pvLength[Search::ply + 1];
+				st.pvLength[st.ply] = st.pvLength[st.ply + 1];
 
 				// using fail-hard beta cutoff
 				if (score >= beta) {
 					// store hash entry
-					writeHashEntry(beta, bestMove, depth, hashfBETA, pos);
+					writeHashEntry(beta, bestMove, depth, hashfBETA, st.ply, pos);
 
 					if (getMoveCapture(move) == 0) {
-						killerMoves[1][Search::ply] = killerMoves[0][Search::ply];
-						killerMoves[0][Search::ply] = move;
+						st.killerMoves[1][st.ply] = st.killerMoves[0][st.ply];
+						st.killerMoves[0][st.ply] = move;
 					}
 
 					return beta;
@@ -764,23 +743,23 @@ namespace Sloth {
 
 		if (legalMoves == 0) {
 			if (kingCheck) {
-				return -MATE_VALUE + Search::ply;
+				return -MATE_VALUE + st.ply;
 			}
 			else {
 				return contemptFactor(pos);
 			}
 		}
 
-		writeHashEntry(alpha, bestMove, depth, hashFlag, pos);
+		writeHashEntry(alpha, bestMove, depth, hashFlag, st.ply, pos);
 
 		//addScoreToTable(score, alpha, pos, depth, Search::ply, beta, bestMove);
 
 		return alpha; // move fails low
 	}
 
-	static int aspirate(int depth, int score, Position& pos) {
+	static int aspirate(int depth, int score, Position& pos, Search::SearchThread& st) {
 		if (depth == 1) {
-			return Search::negamax(-VALUE_INFINITE, VALUE_INFINITE, depth, false, pos);
+			return Search::negamax(-VALUE_INFINITE, VALUE_INFINITE, depth, false, pos, st);
 		}
 
 		int delta = 50;
@@ -788,7 +767,7 @@ namespace Sloth {
 		int beta = std::min(score + delta, VALUE_INFINITE);
 
 		for (;; delta += delta / 2) {
-			score = Search::negamax(alpha, beta, depth, false, pos);
+			score = Search::negamax(alpha, beta, depth, false, pos, st);
 
 			if (score <= alpha) {
 				beta = (alpha + beta) / 2;
@@ -804,23 +783,29 @@ namespace Sloth {
 		}
 	}
 
-	void Search::search(Position& pos, int depth) {
-		int score = 0;
+	// lazy smp: helper n skips the depths where ((depth + skipPhase) / skipSize) is odd,
+	// so the helpers spread over different depths instead of all searching the same tree
+	static const int skipSize[20] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+	static const int skipPhase[20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
 
-		// clear out garbage
-		nodes = 0;
+	static void clearSearchState(Search::SearchThread& st) {
+		st.ply = 0;
 
-		pos.time.stopped = false;
+		st.nodes = 0;
+		st.flushedNodes = 0;
 
-		followPV = 0;
-		scorePV = 0;
+		st.followPV = 0;
 
-		memset(killerMoves, 0, sizeof(killerMoves));
-		memset(historyMoves, 0, sizeof(historyMoves));
-		memset(pvTable, 0, sizeof(pvTable));
-		memset(pvLength, 0, sizeof(pvLength));
+		memset(st.killerMoves, 0, sizeof(st.killerMoves));
+		memset(st.historyMoves, 0, sizeof(st.historyMoves));
+		memset(st.pvTable, 0, sizeof(st.pvTable));
+		memset(st.pvLength, 0, sizeof(st.pvLength));
 
-		memset(ss, 0, sizeof(ss));
+		memset(st.ss, 0, sizeof(st.ss));
+	}
+
+	static void iterativeDeepening(Position& pos, int depth, Search::SearchThread& st) {
+		int score = 0;
 
 		int alpha = -VALUE_INFINITE;
 		int beta = VALUE_INFINITE;
@@ -829,9 +814,15 @@ namespace Sloth {
 		for (int curDepth = 1; curDepth <= depth; curDepth++) {
 			if (pos.time.stopped) break; // if time is up then stop calculating and return best move so far
 
-			followPV = 1;
+			if (st.id != 0) {
+				int i = (st.id - 1) % 20;
 
-			score = aspirate(curDepth, score, pos);
+				if (((curDepth + skipPhase[i]) / skipSize[i]) % 2) continue;
+			}
+
+			st.followPV = 1;
+
+			score = aspirate(curDepth, score, pos, st);
 
 			if ((score <= alpha) || (score >= beta)) {
 				alpha = -VALUE_INFINITE;
@@ -842,37 +833,79 @@ namespace Sloth {
 			alpha = score - 50;
 			beta = score + 50;
 
-			if (pvLength[0]) {
+			if (st.id == 0 && st.pvLength[0]) {
 				int time = pos.time.getTimeMs() - pos.time.startTime;
 
 				if (time == 0) time = 1;
 
-				U64 nps = static_cast<U64>(nodes / (static_cast<double>(time) / 1000.0));
+				unsigned long long totalNodes = st.nodes + helperNodes;
+
+				U64 nps = static_cast<U64>(totalNodes / (static_cast<double>(time) / 1000.0));
 
 				int hashfull = hashFull();
 
 				if (score > -MATE_VALUE && score < -MATE_SCORE) {
-					printf("info depth %d score mate %d nodes %lld nps %lu hashfull %d time %d pv ", curDepth ,-(score + MATE_VALUE) / 2 - 1, nodes, nps, hashfull, time);
+					printf("info depth %d score mate %d nodes %lld nps %lu hashfull %d time %d pv ", curDepth ,-(score + MATE_VALUE) / 2 - 1, totalNodes, nps, hashfull, time);
 				}
 				else if (score > MATE_SCORE && score < MATE_VALUE) {
-					printf("info depth %d score mate %d nodes %lld nps %lu hashfull %d time %d pv ", curDepth,(MATE_VALUE - score) / 2 + 1, nodes, nps, hashfull, time);
+					printf("info depth %d score mate %d nodes %lld nps %lu hashfull %d time %d pv ", curDepth,(MATE_VALUE - score) / 2 + 1, totalNodes, nps, hashfull, time);
 				}
 				else
-					printf("info depth %d score cp %d nodes %lld nps %lu hashfull %d time %d pv ", curDepth, score, nodes, nps, hashfull, time);
+					printf("info depth %d score cp %d nodes %lld nps %lu hashfull %d time %d pv ", curDepth, score, totalNodes, nps, hashfull, time);
 
 
-				for (int c = 0; c < pvLength[0]; c++) {
-					Movegen::printMove(pvTable[0][c]);
+				for (int c = 0; c < st.pvLength[0]; c++) {
+					Movegen::printMove(st.pvTable[0][c]);
 					printf(" ");
 				}
 
 				printf("\n");
 			}
 		}
+	}
+
+	// every helper searches its own copy of the root position
+	static void helperSearch(Position pos, Search::SearchThread* st, int depth) {
+		iterativeDeepening(pos, depth, *st);
+
+		helperNodes += st->nodes - st->flushedNodes;
+	}
+
+	unsigned long long Search::search(Position& pos, int depth) {
+		std::vector<SearchThread> threads(threadCount);
+
+		// clear out garbage
+		for (int id = 0; id < threadCount; id++) {
+			clearSearchState(threads[id]);
+			threads[id].id = id;
+		}
+
+		pos.time.stopped = false;
+
+		hashGeneration += GENERATION_DELTA; // entries of the previous searches age by one step
+
+		stopSearch = false;
+		helperNodes = 0;
+
+		std::vector<std::thread> helpers;
+
+		for (int id = 1; id < threadCount; id++) {
+			helpers.emplace_back(helperSearch, pos, &threads[id], depth);
+		}
+
+		iterativeDeepening(pos, depth, threads[0]);
+
+		// the main thread decides when the search is over, the helpers' results live on in the hash table
+		stopSearch = true;
+
+		for (std::thread& helper : helpers) {
+			helper.join();
+		}
 
 		printf("bestmove ");
-		Movegen::printMove(pvTable[0][0]); // first element within PV table
+		Movegen::printMove(threads[0].pvTable[0][0]); // first element within PV table
 
 		printf("\n");
-	}
 
+		return threads[0].nodes + helperNodes;
+	}
\ No newline at end of file
@@ -2,6 +2,15 @@
 #define SEARCH_H_INCLUDED
 
 #include <cstdarg>
+#include <atomic>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 #include "position.h"
 #include "types.h"
@@ -11,42 +20,48 @@
 #undef ASSERT
 #  define ASSERT(a)
 
-static void my_free(void * address) {
-
-   ASSERT(address!=NULL);
-
-   free(address);
-}
-
+static inline void * my_aligned_malloc(size_t size, size_t alignment) {
 
-static void my_fatal(const char format[], ...) {
-
-   va_list ap;
+   void * address;
 
-   ASSERT(format!=NULL);
+   ASSERT(size>0);
 
-   va_start(ap,format);
-   vfprintf(stderr,format,ap);
-   va_end(ap);
+#ifdef _WIN32
+   address = _aligned_malloc(size, alignment);
+#else
+   if (posix_memalign(&address, alignment, size) != 0) address = NULL;
+#endif
 
-   exit(EXIT_FAILURE);
-   // abort();
+   return address;
 }
 
 
-static void * my_malloc(int size) {
+// 2MB aligned and rounded up to whole 2MB pages so that linux can back it with transparent huge pages
+static inline void * my_large_malloc(size_t size) {
 
+   const size_t alignment = (size_t)2 << 20;
    void * address;
 
-   ASSERT(size>0);
+   size = (size + alignment - 1) & ~(alignment - 1);
 
-   address = malloc(size);
-   if (address == NULL) my_fatal("my_malloc(): malloc(): %s\n",strerror(errno));
+   address = my_aligned_malloc(size, alignment);
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+   if (address != NULL) madvise(address, size, MADV_HUGEPAGE);
+#endif
 
    return address;
 }
 
 
+static inline void my_aligned_free(void * address) {
+
+#ifdef _WIN32
+   _aligned_free(address);
+#else
+   free(address);
+#endif
+}
 
 
 namespace Sloth {
@@ -58,30 +73,68 @@ namespace Sloth {
             int staticEval;
         };
 
-        extern int hashEntries;
+        // everything a single search thread writes while it searches, one per thread
+        struct SearchThread {
+            int id = 0; // 0 is the main thread, the one that talks to the gui
+            int ply = 0;
 
-        extern HASHE *hashTable;
+            unsigned long long nodes = 0;
+            unsigned long long flushedNodes = 0; // part of nodes already published to the main thread
 
-        extern U64 repetitionTable[1000];
-        extern int repetitionIndex;
+            int followPV = 0; // still on the pv of the previous iteration, its move gets searched first
 
-        extern int ply;
+            Move killerMoves[2][MAX_PLY];
+            int historyMoves[12][64];
 
-        extern int bestMove;
+            int pvLength[MAX_PLY];
+            Move pvTable[MAX_PLY][MAX_PLY];
 
-        extern int contempt;
+            SearchStack ss[MAX_PLY];
+        };
 
-        void clearHashTable();
-        void initHashTable(int mb);
+        extern size_t hashClusters;
+
+        extern HASHCLUSTER *hashTable;
+
+        extern uint8_t hashGeneration; // bumped at every go, entries from older searches get replaced first
+
+        extern U64 hashSalt; // xor-ed into every key, a new salt on ucinewgame makes the old entries unreachable
 
-        void printMoveScores(Movegen::MoveList* moveList, Position& pos);
+        extern int bestMove;
 
-        extern  int scoreMove(int move, Position& pos);
-        extern  void sortMoves(Movegen::MoveList* moveList, int bestMove, Position& pos);
+        extern int contempt;
 
-        extern  int negamax(int alpha, int beta, int depth, bool cutnode, Position& pos);
+        extern int threadCount; // number of search threads (main thread + lazy smp helpers)
+        extern bool qsearchChecks; // quiet checks on the first quiescence ply and every evasion when quiescence is in check
+        extern std::atomic<bool> stopSearch; // raised by the main thread, polled by the helpers
 
-        void search(Position& pos, int depth);
+        void clearHashTable();
+        void initHashTable(int mb);
+        void newGameHashTable();
+
+        // maps the upper bits of the key onto [0, hashClusters) with a multiply-shift instead of a division
+        inline HASHCLUSTER* hashCluster(U64 key) {
+        #if defined(_MSC_VER)
+            return &hashTable[__umulh(key ^ hashSalt, hashClusters)];
+        #else
+            return &hashTable[(unsigned __int128)(key ^ hashSalt) * hashClusters >> 64];
+        #endif
+        }
+
+        // pulls the cluster of a position into cache before its node starts probing it
+        inline void prefetchHash(U64 key) {
+        #if defined(_MSC_VER)
+            _mm_prefetch((char*)hashCluster(key), _MM_HINT_T0);
+        #else
+            __builtin_prefetch(hashCluster(key));
+        #endif
+        }
+
+        extern  int see(Move move, Position& pos); // static exchange evaluation of a capture
+
+        extern  int negamax(int alpha, int beta, int depth, bool cutnode, Position& pos, SearchThread& st);
+
+        unsigned long long search(Position& pos, int depth); // nodes searched by all threads
     }
 }
 #endif
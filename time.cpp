@@ -88,7 +88,7 @@
 			stopped = true;
 		}
 
-		readInput();
+		if (listen) readInput();
 	}
 
 
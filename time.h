@@ -32,6 +32,7 @@ namespace Sloth {
 		int startTime = 0;
 		int stopTime = 0;
 		int timeSet = 0;
+		bool listen = true; // false when nothing reads the gui, as for bench run from the command line
 
 		int getTimeMs();
 		int inputWaiting();
@@ -2,6 +2,7 @@
 #define TYPES_H_INCLUDED
 
 //#include <cstdint>
+#include <atomic>
 #include "bitboards.h"
 #pragma warning(disable: 4554)
 
@@ -17,10 +18,16 @@
 
 #define MAX_PLY 64
 
+#define MAX_THREADS 256
+
+//#define COPY_MAKE // take moves back by restoring a copy of the board instead of unmakeMove, to compare the two
+
+//#define USE_PEXT // index the slider attack tables with BMI2 pext instead of magic multiplication, needs -mbmi2
+
 #define NO_HASH_ENTRY 100000
 //#define MAX_HASH 256 // max hash 128 mb
 #define MIN_HASH 16
-#define MAX_HASH 1028
+#define MAX_HASH 65536 // 64 GB
 
 #define hashfEXACT 0
 #define hashfALPHA 1
@@ -32,14 +39,70 @@
 
 #define MAX(A, B) ((A) > (B) ? (A) : (B))
 
-typedef struct { // transposition table
-    U64 hashKey;
-    int depth;
-    int flag; // flag the type of node (fail-high / fail-low / pv)
+typedef uint16_t Move;
+
+// binary move bits, the piece that moves and the piece it takes are read off the board
+    /*
+    0000 0000 0011 1111   source square   0x3f
+    0000 1111 1100 0000   target square   0xfc0
+    1111 0000 0000 0000   flags           0xf000
+    */
+enum MoveFlags {
+    QUIET_MOVE, DOUBLE_PUSH, KING_CASTLE, QUEEN_CASTLE, CAPTURE_MOVE, EN_PASSANT,
+    KNIGHT_PROMOTION = 8, BISHOP_PROMOTION, ROOK_PROMOTION, QUEEN_PROMOTION // | CAPTURE_MOVE for a promotion that takes
+};
+
+#define encodeMove(source, target, flags) (Move)((source) | ((target) << 6) | ((flags) << 12))
+
+#define getMoveSource(move) ((move) & 0x3f)
+
+#define getMoveTarget(move) (((move) & 0xfc0) >> 6)
+
+#define getMoveFlags(move) (((move) & 0xf000) >> 12)
+
+// nonzero for the eight promotion flags, getPromotionPiece is the white piece, Piece::N to Piece::Q
+#define getMovePromotion(move) ((move) & 0x8000)
+
+#define getPromotionPiece(move) (Piece::N + (((move) >> 12) & 3))
+
+#define getMoveCapture(move) ((move) & 0x4000)
+
+#define getDoublePush(move) (((move) & 0xf000) == (DOUBLE_PUSH << 12))
+
+#define getMoveEnpassant(move) (((move) & 0xf000) == (EN_PASSANT << 12))
+
+#define getMoveCastling(move) (((move) & 0xe000) == (KING_CASTLE << 12))
+
+typedef struct { // transposition table entry, unpacked from its 64-bit data word
+    Move bestMove;
+    int depth; // depth + 1, 0 marks an empty slot
+    int genFlag; // generation (upper 6 bits) | flag the type of node (fail-high / fail-low / pv)
     int score; // (alpha, beta, pv)
-    int bestMove;
 } HASHE;
 
+#define CLUSTER_SIZE 6
+
+/*
+    One cache line of entries, a probe only touches one cluster. Each entry is a data word
+
+    0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 1111 1111 1111 1111   move
+    0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 1111 1111 0000 0000 0000 0000   depth + 1
+    0000 0000 0000 0000 0000 0000 0000 0000 1111 1111 0000 0000 0000 0000 0000 0000   generation | flag
+    1111 1111 1111 1111 1111 1111 1111 1111 0000 0000 0000 0000 0000 0000 0000 0000   score
+
+    plus the lower 16 bits of the hash key xor-ed with the data. Both are single atomic stores, so
+    several threads can share the table without locks: an entry torn between two writers fails the key check.
+*/
+typedef struct alignas(64) {
+    std::atomic<U64> data[CLUSTER_SIZE];
+    std::atomic<uint16_t> key[CLUSTER_SIZE];
+    char padding[64 - CLUSTER_SIZE * (sizeof(U64) + sizeof(uint16_t))];
+} HASHCLUSTER;
+
+#define GENERATION_DELTA 4 // the lower 2 bits of genFlag hold the flag
+#define GENERATION_CYCLE (255 + GENERATION_DELTA) // keeps the age computation from borrowing out of the flag bits
+#define GENERATION_MASK 0xFC
+
 enum {
     a8, b8, c8, d8, e8, f8, g8, h8,
     a7, b7, c7, d7, e7, f7, g7, h7,
@@ -77,7 +140,7 @@ const int CASTLING_RIGHTS_CONSTANTS[64] = {
 };
 
 enum MoveType {
-    allMoves, captures
+    allMoves, captures, quiets, evasions, qsCaptures, quietChecks
 };
 
 enum Phases {opening, endgame, middlegame};
@@ -5,15 +5,18 @@
 #include <cstring>
 #include <cstdio>
 #include <string>
+#include <sstream>
 #include <algorithm>
 #include <stdlib.h>
 
 #include "uci.h"
 #include "movegen.h"
+#include "magic.h"
 #include "piece.h"
 #include "position.h"
 #include "search.h"
 #include "perft.h"
+#include "bench.h"
 
 #ifndef _WIN32
 #include <cstdio>
@@ -57,27 +60,26 @@ namespace Sloth {
         };
 
         Movegen::MoveList moveList[1];
-        Movegen::generateMoves(pos, moveList, false);
+        Movegen::generateMoves(pos, moveList, MoveType::allMoves);
 
         int sourceSquare = (moveString[0] - 'a') + (8 - (moveString[1] - '0')) * 8;
         int targetSquare = (moveString[2] - 'a') + (8 - (moveString[3] - '0')) * 8;
 
         for (int c = 0; c < moveList->count; c++) {
-            int move = moveList->moves[c];
+            Move move = moveList->moves[c];
 
             if (sourceSquare == getMoveSource(move) && targetSquare == getMoveTarget(move)) {
-                int promoted = getMovePromotion(move);
-
-                if (promoted) {
+                if (getMovePromotion(move)) {
+                    int promoted = getPromotionPiece(move);
                     char pIndex = moveString[4];
 
-                    if ((promoted == Piece::Q || promoted == Piece::q) && pIndex == 'q') {
+                    if (promoted == Piece::Q && pIndex == 'q') {
                         return move;
-                    } else if ((promoted == Piece::R || promoted == Piece::r) && pIndex == 'r') {
+                    } else if (promoted == Piece::R && pIndex == 'r') {
                         return move;
-                    } else if ((promoted == Piece::B || promoted == Piece::b) && pIndex == 'b') {
+                    } else if (promoted == Piece::B && pIndex == 'b') {
                         return move;
-                    } else if ((promoted == Piece::N || promoted == Piece::n) && pIndex == 'n') {
+                    } else if (promoted == Piece::N && pIndex == 'n') {
                         return move;
                     }
 
@@ -121,8 +123,8 @@ namespace Sloth {
 
                 if (move == 0) break;
 
-                Search::repetitionIndex++;
-                Search::repetitionTable[Search::repetitionIndex] = pos.hashKey;
+                pos.repetitionIndex++;
+                pos.repetitionTable[pos.repetitionIndex] = pos.hashKey;
 
                 pos.makeMove(pos, move, MoveType::allMoves);
 
@@ -209,10 +211,10 @@ namespace Sloth {
 
             Search::search(pos, depth);
         } else {
-            if (Bitboards::occupancies[Colors::both] == 0ULL)
+            if (pos.occupancies[Colors::both] == 0ULL)
                 parsePosition(game, "position startpos");
 
-            Perft::perftTest(depth, pos);
+            Perft::perftTest(depth, pos, Search::threadCount, strstr(cmdCpy, "verify") != NULL);
         }
 
         delete[] cmdCpy;
@@ -240,12 +242,21 @@ namespace Sloth {
                 continue;
             } else if (strncmp(input, "position", 8) == 0) {
                 parsePosition(game, input);
-                Search::clearHashTable();
             } else if (strncmp(input, "ucinewgame", 10) == 0) {
                 parsePosition(game, "position startpos");
-                Search::clearHashTable();
+                Search::newGameHashTable();
             } else if (strncmp(input, "go", 2) == 0) {
                 parseGo(game, input);
+            } else if (strncmp(input, "sliderbench", 11) == 0) {
+                Magic::benchmarkSliders();
+            } else if (strncmp(input, "bench", 5) == 0) {
+                Bench::benchCommand(input + 5);
+            } else if (strncmp(input, "perftsuite", 10) == 0) {
+                std::istringstream args(input + 10);
+                std::string path;
+                int maxDepth = 0;
+                args >> path >> maxDepth;
+                Perft::perftSuite(path.c_str(), maxDepth, Search::threadCount);
             } else if (strncmp(input, "quit", 4) == 0) {
                 break;
             } else if (strncmp(input, "uci", 3) == 0) {
@@ -253,18 +264,41 @@ namespace Sloth {
                 printf("id author William Sjolund\n");
                 printf("option name Hash type spin default 64 min %d max %d\n", MIN_HASH, MAX_HASH);
                 printf("option name Contempt type spin default 0 min 0 max 200\n");
+                printf("option name Threads type spin default 1 min 1 max %d\n", MAX_THREADS);
+                printf("option name Clear Hash type button\n");
+                printf("option name QSearch Checks type check default false\n");
+                printf("option name Perft Hash type spin default 64 min 0 max %d\n", MAX_HASH);
+                printf("option name Perft Bulk Counting type check default true\n");
                 printf("uciok\n");
             } else if (!strncmp(input, "setoption name Hash value ", 26)) {
                 sscanf_s(input, "%*s %*s %*s %*s %d", &mbHash);
                 if (mbHash < MIN_HASH) mbHash = MIN_HASH;
                 if (mbHash > MAX_HASH) mbHash = MAX_HASH;
                 Search::initHashTable(mbHash);
+            } else if (!strncmp(input, "setoption name Clear Hash", 25)) {
+                Search::clearHashTable();
             } else if (!strncmp(input, "setoption name Contempt value ", 30)) {
                 int contempt;
                 sscanf_s(input, "%*s %*s %*s %*s %d", &contempt);
                 if (contempt < 0) contempt = 0;
                 if (contempt > 200) contempt = 200;
                 Search::contempt = contempt;
+            } else if (!strncmp(input, "setoption name QSearch Checks value ", 36)) {
+                Search::qsearchChecks = !strncmp(input + 36, "true", 4);
+            } else if (!strncmp(input, "setoption name Perft Hash value ", 32)) {
+                int mb;
+                sscanf_s(input, "%*s %*s %*s %*s %*s %d", &mb);
+                if (mb < 0) mb = 0;
+                if (mb > MAX_HASH) mb = MAX_HASH;
+                Perft::hashMb = mb;
+            } else if (!strncmp(input, "setoption name Perft Bulk Counting value ", 41)) {
+                Perft::bulkCounting = !strncmp(input + 41, "true", 4);
+            } else if (!strncmp(input, "setoption name Threads value ", 29)) {
+                int threads;
+                sscanf_s(input, "%*s %*s %*s %*s %d", &threads);
+                if (threads < 1) threads = 1;
+                if (threads > MAX_THREADS) threads = MAX_THREADS;
+                Search::threadCount = threads;
             }
         }
     }